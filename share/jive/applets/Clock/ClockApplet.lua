@@ -507,44 +507,44 @@ function WordClock:_reDraw(screen)
         local y = self.skin.Clock.offsetY
       
     -- Row 1
-        self.pointer_textIt:zoom(z, z, 1):blit(screen, x + 20*r, y + 50*r)
-        if all or flags.is         then self.pointer_textIs:zoom(z, z, 1):blit(screen, x + 86*r, y + 50*r) end
-        if all or flags.has        then self.pointer_textHas:zoom(z, z, 1):blit(screen, x + 156*r, y + 50*r) end
-        if all or flags.nearly     then self.pointer_textNearly:zoom(z, z, 1):blit(screen, x + 280*r, y + 50*r) end
-        if all or flags.justgone   then self.pointer_textJustgone:zoom(z, z, 1):blit(screen, x + 496*r, y + 50*r) end
+        self.pointer_textIt:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 50*r)
+        if all or flags.is         then self.pointer_textIs:zoomCached(z, z, 1):blit(screen, x + 86*r, y + 50*r) end
+        if all or flags.has        then self.pointer_textHas:zoomCached(z, z, 1):blit(screen, x + 156*r, y + 50*r) end
+        if all or flags.nearly     then self.pointer_textNearly:zoomCached(z, z, 1):blit(screen, x + 280*r, y + 50*r) end
+        if all or flags.justgone   then self.pointer_textJustgone:zoomCached(z, z, 1):blit(screen, x + 496*r, y + 50*r) end
 
     -- Row 2
-        if all or flags.half       then self.pointer_textHalf:zoom(z, z, 1):blit(screen, x + 20*r, y + 108*r) end
-        if all or flags.ten        then self.pointer_textTen:zoom(z, z, 1):blit(screen, x + 163*r, y + 108*r) end
-        if all or flags.aquarter   then self.pointer_textAquarter:zoom(z, z, 1):blit(screen, x + 274*r, y + 108*r) end
-        if all or flags.twenty     then self.pointer_textTwenty:zoom(z, z, 1):blit(screen, x + 579*r, y + 108*r) end
+        if all or flags.half       then self.pointer_textHalf:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 108*r) end
+        if all or flags.ten        then self.pointer_textTen:zoomCached(z, z, 1):blit(screen, x + 163*r, y + 108*r) end
+        if all or flags.aquarter   then self.pointer_textAquarter:zoomCached(z, z, 1):blit(screen, x + 274*r, y + 108*r) end
+        if all or flags.twenty     then self.pointer_textTwenty:zoomCached(z, z, 1):blit(screen, x + 579*r, y + 108*r) end
 
     -- Row 3
-        if all or flags.five       then self.pointer_textFive:zoom(z, z, 1):blit(screen, x + 20*r, y + 165*r) end
-        if all or flags.minutes    then self.pointer_textMinutes:zoom(z, z, 1):blit(screen, x + 169*r, y + 165*r) end
-        if all or flags.to         then self.pointer_textTo:zoom(z, z, 1):blit(screen, x + 425*r, y + 165*r) end
-        if all or flags.past       then self.pointer_textPast:zoom(z, z, 1):blit(screen, x + 537*r, y + 165*r) end
-        if all or flags.hsix       then self.pointer_textHourSix:zoom(z, z, 1):blit(screen, x + 707*r, y + 165*r) end
+        if all or flags.five       then self.pointer_textFive:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 165*r) end
+        if all or flags.minutes    then self.pointer_textMinutes:zoomCached(z, z, 1):blit(screen, x + 169*r, y + 165*r) end
+        if all or flags.to         then self.pointer_textTo:zoomCached(z, z, 1):blit(screen, x + 425*r, y + 165*r) end
+        if all or flags.past       then self.pointer_textPast:zoomCached(z, z, 1):blit(screen, x + 537*r, y + 165*r) end
+        if all or flags.hsix       then self.pointer_textHourSix:zoomCached(z, z, 1):blit(screen, x + 707*r, y + 165*r) end
 
     -- Row 4
-        if all or flags.hseven     then self.pointer_textHourSeven:zoom(z, z, 1):blit(screen, x + 20*r, y + 222*r) end
-        if all or flags.hone       then self.pointer_textHourOne:zoom(z, z, 1):blit(screen, x + 222*r, y + 222*r) end
-        if all or flags.htwo       then self.pointer_textHourTwo:zoom(z, z, 1):blit(screen, x + 363*r, y + 222*r) end
-        if all or flags.hten       then self.pointer_textHourTen:zoom(z, z, 1):blit(screen, x + 513*r, y + 222*r) end
-        if all or flags.hfour      then self.pointer_textHourFour:zoom(z, z, 1):blit(screen, x + 650*r, y + 222*r) end
+        if all or flags.hseven     then self.pointer_textHourSeven:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 222*r) end
+        if all or flags.hone       then self.pointer_textHourOne:zoomCached(z, z, 1):blit(screen, x + 222*r, y + 222*r) end
+        if all or flags.htwo       then self.pointer_textHourTwo:zoomCached(z, z, 1):blit(screen, x + 363*r, y + 222*r) end
+        if all or flags.hten       then self.pointer_textHourTen:zoomCached(z, z, 1):blit(screen, x + 513*r, y + 222*r) end
+        if all or flags.hfour      then self.pointer_textHourFour:zoomCached(z, z, 1):blit(screen, x + 650*r, y + 222*r) end
 
     -- Row 5
-        if all or flags.hfive      then self.pointer_textHourFive:zoom(z, z, 1):blit(screen, x + 20*r, y + 280*r) end
-        if all or flags.hnine      then self.pointer_textHourNine:zoom(z, z, 1):blit(screen, x + 193*r, y + 280*r) end
-        if all or flags.htwelve    then self.pointer_textHourTwelve:zoom(z, z, 1):blit(screen, x + 371*r, y + 280*r) end
-        if all or flags.height     then self.pointer_textHourEight:zoom(z, z, 1):blit(screen, x + 639*r, y + 280*r) end
+        if all or flags.hfive      then self.pointer_textHourFive:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 280*r) end
+        if all or flags.hnine      then self.pointer_textHourNine:zoomCached(z, z, 1):blit(screen, x + 193*r, y + 280*r) end
+        if all or flags.htwelve    then self.pointer_textHourTwelve:zoomCached(z, z, 1):blit(screen, x + 371*r, y + 280*r) end
+        if all or flags.height     then self.pointer_textHourEight:zoomCached(z, z, 1):blit(screen, x + 639*r, y + 280*r) end
 
     -- Row 6
-        if all or flags.heleven    then self.pointer_textHourEleven:zoom(z, z, 1):blit(screen, x + 20*r, y + 338*r) end
-        if all or flags.hthree     then self.pointer_textHourThree:zoom(z, z, 1):blit(screen, x + 222*r, y + 338*r) end
-        if all or flags.oclock     then self.pointer_textOClock:zoom(z, z, 1):blit(screen, x + 398*r, y + 338*r) end
-        if all or flags.am         then self.pointer_textAM:zoom(z, z, 1):blit(screen, x + 627*r, y + 338*r) end
-        if all or flags.pm         then self.pointer_textPM:zoom(z, z, 1):blit(screen, x + 716*r, y + 338*r) end
+        if all or flags.heleven    then self.pointer_textHourEleven:zoomCached(z, z, 1):blit(screen, x + 20*r, y + 338*r) end
+        if all or flags.hthree     then self.pointer_textHourThree:zoomCached(z, z, 1):blit(screen, x + 222*r, y + 338*r) end
+        if all or flags.oclock     then self.pointer_textOClock:zoomCached(z, z, 1):blit(screen, x + 398*r, y + 338*r) end
+        if all or flags.am         then self.pointer_textAM:zoomCached(z, z, 1):blit(screen, x + 627*r, y + 338*r) end
+        if all or flags.pm         then self.pointer_textPM:zoomCached(z, z, 1):blit(screen, x + 716*r, y + 338*r) end
 
         self.textdate:setValue("ON " .. string.upper(WordClock:getDateAsWords(tonumber(os.date("%d")))))
 
@@ -559,22 +559,20 @@ function WordClock:_reDraw(screen)
         -- Hour Pointer
         local angle = (360 / 12) * (h + (m/60))
 
-        local tmp = self.pointer_hour:rotozoom(-angle, 1, 5)
+        local tmp = self.pointer_hour:rotozoomCached(-angle, 1, 5)
         local facew, faceh = tmp:getSize()
         x = math.floor((self.screen_width/2) - (facew/2))
         y = math.floor((self.screen_height/2) - (faceh/2))
         tmp:blit(screen, x, y)
-        tmp:release()
 
         -- Minute Pointer
         local angle = (360 / 60) * m 
 
-        local tmp = self.pointer_minute:rotozoom(-angle, 1, 5)
+        local tmp = self.pointer_minute:rotozoomCached(-angle, 1, 5)
         local facew, faceh = tmp:getSize()
         x = math.floor((self.screen_width/2) - (facew/2))
         y = math.floor((self.screen_height/2) - (faceh/2))
         tmp:blit(screen, x, y)
-        tmp:release()   
 
         self.textdate:setValue(string.upper(WordClock:getDateAsWords(tonumber(os.date("%d")))))
     end
@@ -637,22 +635,20 @@ function Analog:_reDraw(screen)
     -- Hour Pointer
     local angle = (360 / 12) * (h + (m/60))
 
-    local tmp = self.pointer_hour:rotozoom(-angle, self.skinParams.ratio, 5)
+    local tmp = self.pointer_hour:rotozoomCached(-angle, self.skinParams.ratio, 5)
     local facew, faceh = tmp:getSize()
     x = math.floor((self.screen_width/2) - (facew/2))
     y = math.floor((self.screen_height/2) - (faceh/2))
     tmp:blit(screen, x, y)
-    tmp:release()
 
     -- Minute Pointer
     local angle = (360 / 60) * m 
 
-    local tmp = self.pointer_minute:rotozoom(-angle, self.skinParams.ratio, 5)
+    local tmp = self.pointer_minute:rotozoomCached(-angle, self.skinParams.ratio, 5)
     local facew, faceh = tmp:getSize()
     x = math.floor((self.screen_width/2) - (facew/2))
     y = math.floor((self.screen_height/2) - (faceh/2))
     tmp:blit(screen, x, y)
-    tmp:release()
 
     if self.alarmSet then
         local tmp = self.alarmIcon
@@ -1755,19 +1751,19 @@ function WordClock:getWordClockSkin(skinName)
 	        
 	        if w < screen_width then
 	        	s.Clock.offsetX = (screen_width - w)/2
-		        local tmp = Surface:newRGB(screen_width, screen_height)
+		        local tmp = Surface:acquire(screen_width, screen_height)
 		        wordClockBackground:blit(tmp, s.Clock.offsetX, 0)
 		        wordClockBackground:release()
 		        wordClockBackground = tmp
 		    elseif h > screen_height then
-		        local tmp = Surface:newRGB(screen_width, screen_height)
+		        local tmp = Surface:acquire(screen_width, screen_height)
 		        wordClockBackground:blit(tmp, 0, (screen_height - h)/2)
 		        wordClockBackground:release()
 		        wordClockBackground = tmp
 		    elseif h < screen_height then
 	        	s.Clock.offsetY = (screen_height - h)/2
 		        s.Clock.textdate.y = s.Clock.textdate.y + s.Clock.offsetY
-		        local tmp = Surface:newRGB(screen_width, screen_height)
+		        local tmp = Surface:acquire(screen_width, screen_height)
 		        wordClockBackground:blit(tmp, 0, s.Clock.offsetY)
 		        wordClockBackground:release()
 		        wordClockBackground = tmp
@@ -3155,12 +3151,12 @@ function Analog:getAnalogClockSkin(skinName)
 	        local w, h = analogClockBackground:getSize()
 	        
 	        if w > screen_width then
-		        local tmp = Surface:newRGB(screen_width, screen_height)
+		        local tmp = Surface:acquire(screen_width, screen_height)
 		        analogClockBackground:blit(tmp, (screen_width - w)/2, 0)
 		        analogClockBackground:release()
 		        analogClockBackground = tmp
 		    elseif h > screen_height then
-		        local tmp = Surface:newRGB(screen_width, screen_height)
+		        local tmp = Surface:acquire(screen_width, screen_height)
 		        analogClockBackground:blit(tmp, 0, (screen_height - h)/2)
 		        analogClockBackground:release()
 		        analogClockBackground = tmp
@@ -24,6 +24,7 @@ local string        = require("jive.utils.string")
 local Textarea      = require("jive.ui.Textarea")
 local Window        = require("jive.ui.Window")
 local Icon          = require("jive.ui.Icon")
+local Framework     = require("jive.ui.Framework")
 local log           = require("jive.utils.log").logger("applet.ImageViewer")
 local jiveMain      = jiveMain
 
@@ -147,6 +148,13 @@ function getImage(self)
 	return self.image
 end
 
+-- images are decoded no smaller than this, enough to fill the screen
+-- either way round, so large photos are not decoded at full size
+function getImageSize(self)
+	local screenWidth, screenHeight = Framework:getScreenSize()
+	return math.max(screenWidth, screenHeight)
+end
+
 function getText(self)
 	return self.imgFiles[self.currentImage]
 end
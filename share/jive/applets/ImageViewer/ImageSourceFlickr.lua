@@ -6,7 +6,8 @@
 applets.ImageViewer.ImageSourceFlickr - Image source for Image Viewer
 
 =head1 DESCRIPTION
-Reads image list from Flickr
+
+Reads image list from Flickr
 
 =head1 FUNCTIONS
 
@@ -155,7 +156,8 @@ function requestImage(self)
 	local http = SocketHttp(jnt, host, port, "ImageSourceHttp")
 	local req = RequestHttp(function(chunk, err)
 			if chunk then
-				local image = Surface:loadImageData(chunk, #chunk)
+				local size = self:getImageSize()
+				local image = Surface:loadImageDataScaled(chunk, #chunk, size, size)
 				self.image = image
 				log:debug("image ready")
 			elseif err then
@@ -5,7 +5,8 @@
 applets.ImageViewer.ImageSourceHttp - Image source for Image Viewer
 
 =head1 DESCRIPTION
-Reads image list from URL
+
+Reads image list from URL
 
 =head1 FUNCTIONS
 
@@ -124,7 +125,8 @@ function requestImage(self)
 	local http = SocketHttp(jnt, parsed.host, parsed.port, "ImageSourceHttp")
 	local req = RequestHttp(function(chunk, err)
 			if chunk then
-				local image = Surface:loadImageData(chunk, #chunk)
+				local size = self:getImageSize()
+				local image = Surface:loadImageDataScaled(chunk, #chunk, size, size)
 				self.image = image
 				log:debug("image ready")
 			elseif err then
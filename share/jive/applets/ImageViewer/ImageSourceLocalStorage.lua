@@ -164,7 +164,8 @@ function getImage(self)
 	if self.imgFiles[self.currentImage] ~= nil then
 		local file = self.imgFiles[self.currentImage]
 		log:info("Next image in queue: ", file)
-		local image = Surface:loadImage(file)
+		local size = self:getImageSize()
+		local image = Surface:loadImageScaled(file, size, size)
 		return image
 	end
 end
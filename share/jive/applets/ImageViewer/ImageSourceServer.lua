@@ -253,7 +253,8 @@ function requestImage(self, imageData)
 	local http = SocketHttp(jnt, parsed.host, parsed.port, "ImageSourceServer")
 	local req = RequestHttp(function(chunk, err)
 			if chunk then
-				local image = Surface:loadImageData(chunk, #chunk)
+				local size = self:getImageSize()
+				local image = Surface:loadImageDataScaled(chunk, #chunk, size, size)
 				self.image = image
 				log:debug("image ready")
 				self.error = nil
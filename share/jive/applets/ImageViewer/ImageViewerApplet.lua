@@ -63,6 +63,13 @@ local LAYER_CONTENT    = jive.ui.LAYER_CONTENT
 
 local MIN_SCROLL_INTERVAL = 750
 
+-- slides prepared ahead, and kept to go back to
+local PREFETCH_SLIDES = 2
+local HISTORY_SLIDES = 2
+
+-- how long to wait for the image source to fetch an image
+local IMAGE_TIMEOUT = 10000
+
 module(..., Framework.constants)
 oo.class(_M, Applet)
 
@@ -85,9 +92,11 @@ function initImageSource(self, imgSourceOverride)
 
 	self.imgSource = nil
 	self.listCheckCount = 0
-	self.imageCheckCount = 0
 	self.initialized = false
-	self.isRendering = false
+	self.slideWanted = false
+	self.slides = {}
+	self.history = {}
+	self.currentSlide = nil
 	self.dragStart = -1
 	self.dragOffset = 0
 	self.imageError = nil
@@ -347,7 +356,6 @@ function startSlideshowWhenReady(self)
 	end
 
 	-- image list is ready
-	self.imgSource:nextImage(self:getSettings()["ordering"])
 	self:displaySlide()
 end
 
@@ -365,7 +373,7 @@ function showTextWindow(self)
 		},
 	})
 	
-	local info = self.imgSource:getMultilineText()
+	local info = self.currentSlide and self.currentSlide.text or ""
 	for x, line in ipairs(string.split("\n", info)) do
 		if line > "" then
 			menu:addItem({
@@ -452,9 +460,8 @@ end
 function setupEventHandlers(self, window)
 
 	local nextSlideAction = function (self)
-		if self.imgSource:imageReady() and not self.isRendering then
+		if not self.slideWanted then
 			log:debug("request next slide")
-			self.imgSource:nextImage(self:getSettings()["ordering"])
 			self:displaySlide()
 		else
 			log:warn("don't show next image - current image isn't even ready yet")
@@ -463,11 +470,9 @@ function setupEventHandlers(self, window)
 	end
 
 	local previousSlideAction = function (self, window)
-		if self.imgSource:imageReady() and not self.isRendering then
+		if not self.slideWanted then
 			log:debug("request prev slide")
-			self.useFastTransition = true
-			self.imgSource:previousImage(self:getSettings()["ordering"])
-			self:displaySlide()
+			self:_showPreviousSlide()
 		else
 			log:warn("don't show next image - current image isn't even ready yet")
 		end
@@ -616,10 +621,6 @@ end
 
 function free(self)
 	log:info("destructor of image viewer")
-	if self.task then
-		self.task:removeTask()
-	end
-
 	if self.window then
 		self.window:setAllowScreensaver(true)
 	end
@@ -637,9 +638,11 @@ function _stopTimers(self)
 	if self.nextSlideTimer then
 		self.nextSlideTimer:stop()
 	end
-	if self.checkFotoTimer then
-		self.checkFotoTimer:stop()
+	if self.prefetchTask then
+		self.prefetchTask:removeTask()
+		self.prefetchTask = nil
 	end
+	self.slideWanted = false
 end
 
 function applyScreensaverWindow(self, window)
@@ -658,65 +661,81 @@ function applyScreensaverWindow(self, window)
 end
 
 
+-- show the next prepared slide, or the next one to finish preparing
 function displaySlide(self)
 	if not self.initialized then
 		self:initImageSource()
 		self.initialized = true
 	end
 
-	-- stop timer
-	if self.checkFotoTimer then
-		self.checkFotoTimer:stop()
+	--stop next slider Timer since this call to displaySlide may have been manually triggered
+	if self.nextSlideTimer then
+		self.nextSlideTimer:stop()
 	end
 
-	if self.nextSlideTimer and self.nextSlideTimer:isRunning() then
-		--restart next slide timer to give this image a chance, can happen when displaySlide was manually trigger
-		self.nextSlideTimer:restart()
+	local slide = table.remove(self.slides, 1)
+	if slide then
+		self:_showSlide(slide)
+	else
+		log:debug("slide not prepared yet, show it when it is")
+		self.slideWanted = true
 	end
 
-	if not self.imgSource:imageReady() and self.imageCheckCount < 50 then
-		self.imageCheckCount = self.imageCheckCount + 1
-		
-		-- try again in a few moments
-		log:debug("image not ready, try again...")
+	self:_prefetchSlides()
+end
 
-		if not self.checkFotoTimer then
-			self.checkFotoTimer = Timer(200, --hmm, this seems to enforce a second wait even if response is fast....
-				function()
-					self:displaySlide()
-				end,
-				true)
-		end
-		self.checkFotoTimer:restart()
+
+-- fetch, scale and compose the next slides in the background, so that
+-- changing slides is just a window transition
+function _prefetchSlides(self)
+	if self.prefetchTask or #self.slides >= PREFETCH_SLIDES then
 		return
 	end
-	
-	self.imageCheckCount = 0
 
-	log:debug("image rendering")
-	self.isRendering = true
+	self.prefetchTask = Task("prefetchImages", self,
+		function()
+			while #self.slides < PREFETCH_SLIDES do
+				local slide = self:_prepareSlide(self.prefetchTask)
 
-	--stop next slider Timer since a) we have a good image and, b) this call to displaySlide may have been manually triggered
-	if self.nextSlideTimer then
-		self.nextSlideTimer:stop()
-	end
+				table.insert(self.slides, slide)
+
+				if self.slideWanted then
+					self.slideWanted = false
+					self:_showSlide(table.remove(self.slides, 1))
+				end
+			end
 
-	self.task = Task("renderImage", self, function() self:_renderImage() end)
-	self.task:addTask()
+			local task = self.prefetchTask
+			self.prefetchTask = nil
+			task:removeTask()
+		end)
+	self.prefetchTask:addTask()
 end
 
-function _renderImage(self)
+
+-- advance the image source, and render its image to a screen sized surface
+function _prepareSlide(self, task)
+	self.imgSource:nextImage(self:getSettings()["ordering"])
+
+	-- wait for the image source to fetch the image
+	local timeout = Framework:getTicks() + IMAGE_TIMEOUT
+	while not self.imgSource:imageReady() and Framework:getTicks() < timeout do
+		task:yield()
+	end
+
+	log:debug("image rendering")
+
 	-- get device orientation and features
 	local screenWidth, screenHeight = Framework:getScreenSize()
 	
 	local rotation = self:getSettings()["rotation"]
 	local fullScreen = self:getSettings()["fullscreen"]
-	local ordering = self:getSettings()["ordering"]
 	local textinfo = self:getSettings()["textinfo"]
 
 	local deviceLandscape = ((screenWidth/screenHeight) > 1)
 
-	local image = self.imgSource:getImage()
+	local source = self.imgSource:getImage()
+	local image = source
 	local w, h;
 	
 	if image ~= nil then
@@ -724,105 +743,116 @@ function _renderImage(self)
 	end
 
 	-- give SP some time to breath...	
-	self.task:yield()
+	task:yield()
 
-	if image ~= nil and w > 0 and h > 0 then
-	
-		self.imageError = nil
-	
-		if self.imgSource:useAutoZoom() then
-			local imageLandscape = ((w/h) > 1)
-
-			-- determine whether to rotate
-			if rotation then
-				-- rotation allowed
-				if deviceLandscape ~= imageLandscape then
-					-- rotation needed, so let's do it
-					image = image:rotozoom(-90, 1, 1)
-					w, h = image:getSize()
-
-					-- rotating the image is exhausting...	
-					self.task:yield()
-				end
-			end
+	if image == nil or w == 0 or h == 0 then
+		return {
+			error = tostring(self.imgSource:getErrorMessage())
+		}
+	end
 
-			-- determine scaling factor
-			local zoomX = screenWidth / w
-			local zoomY = screenHeight / h
-			local zoom = 1
-
-			--[[
-			log:info("pict " .. w .. "x" .. h)
-			log:info("screen " .. screenWidth .. "x" .. screenHeight)
-			log:info("zoomX " .. zoomX)
-			log:info("zoomY " .. zoomY)
-			log:info("deviceCanRotate " .. tostring(deviceCanRotate))
-			log:info("rotation " .. rotation)
-			log:info("fullscreen " .. tostring(fullScreen))
-			--]]
-
-			if fullScreen then
-				zoom = math.max(zoomX, zoomY)
-			else
-				zoom = math.min(zoomX, zoomY)
-			end
+	if self.imgSource:useAutoZoom() then
+		local imageLandscape = ((w/h) > 1)
 
-			-- scale image if needed
-			if zoom ~= 1 then
-				image = image:rotozoom(0, zoom, 1)
-				w, h = image:getSize()
-			end
+		-- rotate if allowed and needed, in the same pass as the zoom
+		local angle = 0
+		if rotation and deviceLandscape ~= imageLandscape then
+			angle = -90
+			w, h = h, w
+		end
+
+		-- determine scaling factor
+		local zoomX = screenWidth / w
+		local zoomY = screenHeight / h
+		local zoom = 1
 
-			-- zooming is hard work!	
-			self.task:yield()
+		if fullScreen then
+			zoom = math.max(zoomX, zoomY)
+		else
+			zoom = math.min(zoomX, zoomY)
 		end
 
-		-- place scaled image centered to empty picture
-		local totImg = Surface:newRGBA(screenWidth, screenHeight)
-		totImg:filledRectangle(0, 0, screenWidth, screenHeight, 0x000000FF)
-		local x, y = math.floor ((screenWidth - w) / 2), math.floor ((screenHeight - h) / 2)
+		-- the sources decode images no larger than needed to fill the
+		-- screen, so this rotates and scales a screen sized image once
+		if angle ~= 0 or zoom ~= 1 then
+			image = image:rotozoom(angle, zoom, 1)
+			w, h = image:getSize()
+		end
 
-		-- draw image
-		image:blit(totImg, x, y)
+		-- zooming is hard work!	
+		task:yield()
+	end
 
-		image = totImg
+	-- place scaled image centered to empty picture
+	local totImg = Surface:acquire(screenWidth, screenHeight, true)
+	totImg:filledRectangle(0, 0, screenWidth, screenHeight, 0x000000FF)
+	local x, y = math.floor ((screenWidth - w) / 2), math.floor ((screenHeight - h) / 2)
 
-		if textinfo then
-			-- add text to image
-			local txtLeft, txtCenter, txtRight = self.imgSource:getText()
+	-- draw image
+	image:blit(totImg, x, y)
 
-			if txtLeft or txtCenter or txtRight then
-				image:filledRectangle(0,screenHeight-20,screenWidth,screenHeight, 0x000000FF)
-				local fontBold = Font:load("fonts/FreeSansBold.ttf", 10)
-				local fontRegular = Font:load("fonts/FreeSans.ttf", 10)
+	-- free the rotated or scaled copy now rather than waiting for the gc
+	if image ~= source then
+		image:release()
+	end
 
-				if txtLeft then
-					-- draw left text
-					local txt1 = Surface:drawText(fontBold, 0xFFFFFFFF, txtLeft)
-					txt1:blit(image, 5, screenHeight-15 - fontBold:offset())
-				end
+	image = totImg
 
-				if txtCenter then
-					-- draw center text
-					local titleWidth = fontRegular:width(txtCenter)
-					local txt2 = Surface:drawText(fontRegular, 0xFFFFFFFF, txtCenter)
-					txt2:blit(image, (screenWidth-titleWidth)/2, screenHeight-15-fontRegular:offset())
-				end
+	if textinfo then
+		-- add text to image
+		local txtLeft, txtCenter, txtRight = self.imgSource:getText()
 
-				if txtRight then
-					-- draw right text
-					local titleWidth = fontRegular:width(txtRight)
-					local txt3 = Surface:drawText(fontRegular, 0xFFFFFFFF, txtRight)
-					txt3:blit(image, screenWidth-5-titleWidth, screenHeight-15-fontRegular:offset())
-				end
+		if txtLeft or txtCenter or txtRight then
+			image:filledRectangle(0,screenHeight-20,screenWidth,screenHeight, 0x000000FF)
+			local fontBold = Font:load("fonts/FreeSansBold.ttf", 10)
+			local fontRegular = Font:load("fonts/FreeSans.ttf", 10)
+
+			if txtLeft then
+				-- draw left text
+				local txt1 = Surface:drawText(fontBold, 0xFFFFFFFF, txtLeft)
+				txt1:blit(image, 5, screenHeight-15 - fontBold:offset())
+			end
+
+			if txtCenter then
+				-- draw center text
+				local titleWidth = fontRegular:width(txtCenter)
+				local txt2 = Surface:drawText(fontRegular, 0xFFFFFFFF, txtCenter)
+				txt2:blit(image, (screenWidth-titleWidth)/2, screenHeight-15-fontRegular:offset())
+			end
+
+			if txtRight then
+				-- draw right text
+				local titleWidth = fontRegular:width(txtRight)
+				local txt3 = Surface:drawText(fontRegular, 0xFFFFFFFF, txtRight)
+				txt3:blit(image, screenWidth-5-titleWidth, screenHeight-15-fontRegular:offset())
 			end
 		end
+	end
+
+	log:debug("image rendering done")
+
+	-- the large surfaces are already released, a step keeps on top of the
+	-- rest without a full collection on the ui thread
+	collectgarbage("step")
+
+	return {
+		image = image,
+		text = self.imgSource:getMultilineText(),
+	}
+end
 
-		local window = Window('window')
-		window:addWidget(Icon("icon", image))
 
-		-- give SP some time to breath...	
-		self.task:yield()
+-- show a prepared slide, and start the timer for the next one
+function _showSlide(self, slide)
+	if self.nextSlideTimer then
+		self.nextSlideTimer:stop()
+	end
+
+	if slide.image then
+		self.imageError = nil
+
+		local window = Window('window')
+		window:addWidget(Icon("icon", slide.image))
 
 		if self.isScreensaver then
 			self:applyScreensaverWindow(window)
@@ -854,9 +884,22 @@ function _renderImage(self)
 		--no iconbar
 		self.window:setShowFrameworkWidgets(false)
 
+		-- keep the last few slides to go back to
+		if self.currentSlide then
+			table.insert(self.history, self.currentSlide)
+			if #self.history > HISTORY_SLIDES then
+				-- frame goes back to the surface pool for a later slide
+				local old = table.remove(self.history, 1)
+				if old.image then
+					old.image:release()
+				end
+			end
+		end
+		self.currentSlide = slide
+
 	else
 		if self.imageError == nil then
-			self.imageError = tostring(self.imgSource:getErrorMessage())
+			self.imageError = slide.error
 			log:error("Invalid image object found: " .. self.imageError)
 
 			local popup = self.imgSource:popupMessage(self:string("IMAGE_VIEWER_INVALID_IMAGE"), self.imageError)
@@ -871,21 +914,28 @@ function _renderImage(self)
 	local delay = self:getSettings()["delay"]
 	self.nextSlideTimer = self.window:addTimer(delay,
 		function()
-			self.imgSource:nextImage(self:getSettings()["ordering"])
 			self:displaySlide()
 		end
 	)
-	
+end
 
-	log:debug("image rendering done")
 
-	-- free memory as quickly as possible - resizing large images might have consumed a lot of it
-	collectgarbage("collect")
+-- show the previous slide again, the current one is shown next
+function _showPreviousSlide(self)
+	local slide = table.remove(self.history)
+	if not slide then
+		log:debug("no previous slide")
+		return
+	end
 
-	self.isRendering = false
-	self.task:removeTask()
-end
+	if self.currentSlide then
+		table.insert(self.slides, 1, self.currentSlide)
+		self.currentSlide = nil
+	end
 
+	self.useFastTransition = true
+	self:_showSlide(slide)
+end
 
 -- Configuration menu
 
@@ -149,6 +149,18 @@ function param(self)
 				localPlayerOnly = 1,
 				text = self:string("ANALOG_VU_METER"),
 			},
+			{
+				style = 'nowplaying_scope_text',
+				artworkSize = midArtwork,
+				localPlayerOnly = 1,
+				text = self:string("OSCILLOSCOPE"),
+			},
+			{
+				style = 'nowplaying_spectrogram_text',
+				artworkSize = midArtwork,
+				localPlayerOnly = 1,
+				text = self:string("SPECTROGRAM"),
+			},
 		},
 	}
 end
@@ -3623,6 +3635,52 @@ function skin(self, s, reload, useDefaultSize, w, h)
 		},
 	})
 
+	-- Visualizer: Oscilloscope
+	s.nowplaying_scope_text = _uses(s.nowplaying_spectrum_text, {
+		npvisu = {
+			oscilloscope = {
+				position = LAYOUT_NONE,
+				x = 0,
+				y = 2 * TITLE_HEIGHT + 4,
+				w = 800,
+				h = 446 - (2 * TITLE_HEIGHT + 4 + 45),
+				border = { 0, 0, 0, 0 },
+				padding = { 0, 0, 0, 0 },
+
+				bg = { 0x00, 0x00, 0x00, 0xff },
+				leftColor = { 0x14, 0xbc, 0xbc, 0xff },
+				rightColor = { 0x74, 0x56, 0xa1, 0xff },
+
+				isMono = 0,				-- 0 / 1
+				scrollSpeed = 2,			-- columns per frame
+			}
+		},
+	})
+	s.nowplaying_scope_text.pressed = s.nowplaying_scope_text
+
+	-- Visualizer: Spectrogram
+	s.nowplaying_spectrogram_text = _uses(s.nowplaying_spectrum_text, {
+		npvisu = {
+			spectrogram = {
+				position = LAYOUT_NONE,
+				x = 0,
+				y = 2 * TITLE_HEIGHT + 4,
+				w = 800,
+				h = 446 - (2 * TITLE_HEIGHT + 4 + 45),
+				border = { 0, 0, 0, 0 },
+				padding = { 0, 0, 0, 0 },
+
+				bg = { 0x00, 0x00, 0x00, 0xff },
+				lowColor = { 0x74, 0x56, 0xa1, 0xff },
+				highColor = { 0x14, 0xbc, 0xbc, 0xff },
+
+				binHeight = 4,				-- >= 1
+				scrollSpeed = 1,			-- columns per frame
+			}
+		},
+	})
+	s.nowplaying_spectrogram_text.pressed = s.nowplaying_spectrogram_text
+
 	s.brightness_group = {
 		order = {  'down', 'div1', 'slider', 'div2', 'up' },
 		position = LAYOUT_SOUTH,
@@ -32,6 +32,8 @@ local Player           = require("jive.slim.Player")
 
 local VUMeter          = require("jive.vis.VUMeter")
 local SpectrumMeter    = require("jive.vis.SpectrumMeter")
+local Oscilloscope     = require("jive.vis.Oscilloscope")
+local Spectrogram      = require("jive.vis.Spectrogram")
 
 local debug            = require("jive.utils.debug")
 local datetime         = require("jive.utils.datetime")
@@ -584,6 +586,24 @@ function notify_playerPlaylistChange(self, player)
 	self:_updateAll()
 end
 
+function notify_playerPositionChange(self, player, elapsed, duration)
+	if player ~= self.player or not self.window then
+		return
+	end
+	log:debug("notify_playerPositionChange(): ", elapsed, " ", duration)
+
+	-- the progress bar range follows the duration
+	self:_updateProgress(player:getPlayerStatus())
+end
+
+function notify_playerVolumeChange(self, player, volume)
+	if player ~= self.player then
+		return
+	end
+	log:debug("notify_playerVolumeChange(): ", volume)
+	self:_updateVolume()
+end
+
 function _nowPlayingTrackTransition(oldWindow, newWindow)
 	_assert(oo.instanceof(oldWindow, Widget))
 	_assert(oo.instanceof(newWindow, Widget))
@@ -1557,6 +1577,7 @@ function _createUI(self)
 	)
 
 	-- Visualizer: Spectrum Visualizer - only load if needed
+	self.visuGroup = nil
 	if self.windowStyle == "nowplaying_spectrum_text" then
 		self.visuGroup = Button(
 			Group('npvisu', {
@@ -1582,6 +1603,32 @@ function _createUI(self)
 		)
 	end
 
+	-- Visualizer: Oscilloscope - only load if needed
+	if self.windowStyle == "nowplaying_scope_text" then
+		self.visuGroup = Button(
+			Group('npvisu', {
+				visu = Oscilloscope("oscilloscope"),
+			}),
+			function()
+				Framework:pushAction("go_now_playing")
+				return EVENT_CONSUME
+			end
+		)
+	end
+
+	-- Visualizer: Spectrogram - only load if needed
+	if self.windowStyle == "nowplaying_spectrogram_text" then
+		self.visuGroup = Button(
+			Group('npvisu', {
+				visu = Spectrogram("spectrogram"),
+			}),
+			function()
+				Framework:pushAction("go_now_playing")
+				return EVENT_CONSUME
+			end
+		)
+	end
+
 	local playIcon = Button(Icon('play'),
 				function() 
 					Framework:pushAction("pause")
@@ -1738,7 +1785,7 @@ function _createUI(self)
 	window:addWidget(self.artistalbumTitle)
 	window:addWidget(self.artworkGroup)
 	-- Visualizer: Only load if needed
-	if (self.windowStyle == "nowplaying_spectrum_text") or (self.windowStyle == "nowplaying_vuanalog_text") then
+	if self.visuGroup then
 		window:addWidget(self.visuGroup)
 	end
 
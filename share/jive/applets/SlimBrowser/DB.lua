@@ -22,6 +22,12 @@ Fresh data always refreshes old data, except if it would be cost prohibitive to
 There should be one DB per long list "type". If the count or the timestamp of the long list
 is different from the existing stored info, the existing info is discarded.
 
+Playlists are the exception: when the new playlist is the old one with tracks removed
+from the top and/or added to the bottom, as in party mode, the stored items are shifted
+in place and only the new tracks at the bottom are loaded. The shift is only inferred from
+the status window, so the head of the playlist and the last kept items are loaded first to
+confirm it, and anything that does not match drops the data.
+
 =head1 SYNOPSIS
 
 TODO
@@ -47,6 +53,9 @@ module(..., oo.class)
 
 local BLOCK_SIZE = 200
 
+-- items loaded at each end of the kept part of a shifted playlist to confirm the shift
+local VERIFY_SIZE = 10
+
 -- init
 -- creates an empty database object
 function __init(self, windowSpec)
@@ -67,6 +76,8 @@ function __init(self, windowSpec)
 		-- cache
 		last_indexed_chunk = false,
 		complete = false,
+		partialFrom = false, -- first missing index of a block left partly filled by a delta
+		verify = false,      -- ranges { from, qty } to check after a delta
 		
 		-- windowSpec (to create labels in renderer)
 		windowSpec = windowSpec,
@@ -100,8 +111,140 @@ function getRadioGroup(self)
 end
 
 
+-- key identifying a playlist item, to match items between playlist versions
+local function _itemKey(item)
+	if not item then
+		return nil
+	end
+	return item.params and item.params.track_id or item.text
+end
+
+
+-- store an item at a 1-based index
+local function _storeItem(self, index, item)
+	local key = math.floor((index - 1) / BLOCK_SIZE)
+
+	if not self.store[key] then
+		self.store[key] = {}
+	end
+	self.store[key][math.fmod(index - 1, BLOCK_SIZE) + 1] = item
+end
+
+
+-- drop the stored data
+local function _reset(self)
+	self.store = {}
+	self.complete = false
+	self.upCompleted = false
+	self.downCompleted = false
+	self.searchDirection = nil
+	self.partialFrom = false
+	self.verify = false
+	self.textIndex = {}
+end
+
+
+-- index the textkey of an item, holding the lowest index for each key
+local function _indexText(self, index, item)
+	local textKey = item.textkey or (item.params and item.params.textkey)
+	if textKey then
+		local textKeyIndex = self.textIndex[textKey]
+		if not textKeyIndex or textKeyIndex > index then
+			self.textIndex[textKey] = index
+		end
+	end
+end
+
+
+-- _playlistDelta
+-- Try to turn the stored playlist into the new one given in chunk by dropping
+-- items from the top, returns the number of items dropped or nil if the
+-- playlist must be reloaded. The items in the chunk must match the stored
+-- items once shifted, and the stored playlist must be complete and not be
+-- waiting for an earlier shift to be confirmed.
+local function _playlistDelta(self, chunk, count, ts)
+	local items = chunk["item_loop"]
+	local offset = tonumber(chunk["offset"] or chunk["playlist_cur_index"])
+
+	if not (self.complete and not self.verify and self.ts and ts and offset and items and items[1]) then
+		return nil
+	end
+
+	-- find the first item of the chunk in the old playlist
+	local first = _itemKey(items[1])
+	local shift
+	for index = offset + 1, self.count do
+		if _itemKey(self:item(index)) == first then
+			shift = index - offset - 1
+			break
+		end
+	end
+
+	-- the items kept must still fit, and the change is a shift or an append,
+	-- moves and edits in place keep the count and are not detected here
+	local kept = shift and (self.count - shift)
+	if not kept or kept <= 0 or kept > count or (shift == 0 and count == self.count) then
+		return nil
+	end
+
+	for i, item in ipairs(items) do
+		local index = offset + i
+		if index > kept then
+			break
+		end
+		if _itemKey(self:item(index + shift)) ~= _itemKey(item) then
+			return nil
+		end
+	end
+
+	log:debug("..store shifted by ", shift, ", loading ", count - kept, " new items")
+
+	if shift > 0 then
+		local old = self.store
+
+		self.store = {}
+		self.textIndex = {}
+
+		for index = 1, kept do
+			local key = math.floor((index + shift - 1) / BLOCK_SIZE)
+			local item = old[key][math.fmod(index + shift - 1, BLOCK_SIZE) + 1]
+
+			if item.params and type(item.params.playlist_index) == "number" then
+				item.params.playlist_index = index - 1
+			end
+
+			_storeItem(self, index, item)
+			_indexText(self, index, item)
+		end
+	end
+
+	-- the new items at the bottom are loaded by missing()
+	self.complete = (kept == count)
+	self.upCompleted = true
+	self.downCompleted = false
+	self.searchDirection = 'down'
+	self.partialFrom = math.fmod(kept, BLOCK_SIZE) ~= 0 and kept < count and kept
+
+	-- the window only matched around offset. confirm the head, and the
+	-- last items kept as a delete below the window moves them
+	local verify = {}
+	if offset > 0 then
+		verify[#verify + 1] = { 0, math.min(VERIFY_SIZE, kept) }
+	end
+	local checked = offset + #items
+	if checked < kept then
+		local n = math.min(VERIFY_SIZE, kept - checked)
+		verify[#verify + 1] = { kept - n, n }
+	end
+	self.verify = #verify > 0 and verify
+
+	return shift
+end
+
+
 -- status
--- Update the DB status from the chunk.
+-- Update the DB status from the chunk. Returns true if the stored data was
+-- dropped, and the number of items shifted off the top by a playlist delta.
 function updateStatus(self, chunk)
 	-- sanity check on the chunk
 	_assert(chunk["count"], "chunk must have count field")
@@ -133,12 +276,14 @@ function updateStatus(self, chunk)
 		reset = true
 	end
 
+	-- a playlist may only have changed at the ends
+	local shift = reset and ts and _playlistDelta(self, chunk, cCount, ts)
+	if shift then
+		reset = false
+	end
+
 	if reset then
-		self.store = {}
-		self.complete = false
-		self.upCompleted = false
-		self.downCompleted = false
-		self.textIndex = {}
+		_reset(self)
 	end
 
 	-- update the window properties
@@ -158,7 +303,7 @@ function updateStatus(self, chunk)
 	self.ts = ts
 	self.count = cCount
 
-	return reset
+	return reset, shift or 0
 end
 
 
@@ -195,19 +340,41 @@ function menuItems(self, chunk)
 	log:debug('********************************* cFrom: ', cFrom)
 	log:debug('********************************* cTo:   ', cTo)
 
-	self.store[key] = chunk["item_loop"]
+	-- the items kept by a playlist delta must match, or the delta was
+	-- wrong and everything is loaded again
+	local check = self.verify and self.verify[1]
+	if check and cFrom - 1 == check[1] then
+		for i = 1, math.min(check[2], #chunk["item_loop"]) do
+			if _itemKey(self:item(cFrom + i - 1)) ~= _itemKey(chunk["item_loop"][i]) then
+				log:info("playlist shift not confirmed, reloading")
+				_reset(self)
+				return self.count, 1, self.count
+			end
+		end
+
+		table.remove(self.verify, 1)
+		if #self.verify == 0 then
+			self.verify = false
+		end
+	end
+
+	if self.partialFrom and cFrom - 1 <= self.partialFrom and cTo > self.partialFrom then
+		self.partialFrom = false
+	end
+
+	-- whole blocks replace the stored block, anything else is patched in
+	local aligned = math.fmod(cFrom - 1, BLOCK_SIZE) == 0 and #chunk["item_loop"] <= BLOCK_SIZE
+		and (#chunk["item_loop"] == BLOCK_SIZE or cTo >= self.count)
+	if aligned or self.count == 0 then
+		self.store[key] = chunk["item_loop"]
+	end
 
 	for i,item in ipairs(chunk["item_loop"]) do
 		local index = i + tonumber(chunk["offset"])
-		local textKey = item.textkey or (item.params and item.params.textkey)
-		if textKey then
-			local textKeyIndex = self.textIndex[textKey]
-			if not textKeyIndex or textKeyIndex > index then
-				--hold lowest index for the given textKey
-				self.textIndex[textKey] = index
-			end
-			
+		if not aligned then
+			_storeItem(self, index, item)
 		end
+		_indexText(self, index, item)
 	end
 	return self.count, cFrom, cTo
 end
@@ -264,6 +431,11 @@ end
 -- the missing method's job is to identify the next chunk to load
 function missing(self, index)
 
+	-- confirm a playlist delta before loading anything else
+	if self.verify then
+		return self.verify[1][1], self.verify[1][2]
+	end
+
 	-- use our cached result
 	if self.complete then
 		log:debug(self, " complete (cached)")
@@ -278,6 +450,12 @@ function missing(self, index)
 
 	local count = tonumber(self.last_chunk.count)
 
+	-- finish the block left partly filled by a playlist delta
+	if self.partialFrom then
+		local from = self.partialFrom
+		return from, math.min(count, (math.floor(from / BLOCK_SIZE) + 1) * BLOCK_SIZE) - from
+	end
+
 	-- determine the key for the last chunk in the chunk list
 	local lastKey = 0
 	if count > BLOCK_SIZE then
@@ -3714,9 +3714,17 @@ function notify_playerPlaylistChange(self, player)
 		_emptyStep = nil
 	end
 
-	-- update the window
-	step.db:updateStatus(playerStatus)
-	step.menu:reLayout()
+	-- update the window, a playlist changed only at the ends keeps its items
+	local reset, shift = step.db:updateStatus(playerStatus)
+	if reset then
+		step.menu:reLayout()
+	else
+		local selected = step.menu:getSelectedIndex()
+		if selected and shift > 0 then
+			step.menu:setSelectedIndex(math.max(1, selected - shift))
+		end
+		step.menu:setItems(step, step.db:size())
+	end
 
 	-- does the playlist need loading?
 	_requestStatus()
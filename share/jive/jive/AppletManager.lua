@@ -21,6 +21,7 @@ TODO
 local package, pairs, error, load, loadfile, io, assert, os = package, pairs, error, load, loadfile, io, assert, os
 local setfenv, getfenv, require, pcall, unpack = setfenv, getfenv, require, pcall, unpack
 local tostring, tonumber, collectgarbage = tostring, tonumber, collectgarbage
+local ipairs, loadstring = ipairs, loadstring
 
 local string           = require("jive.utils.string")
                        
@@ -36,6 +37,10 @@ local dumper           = require("jive.utils.dumper")
 local table            = require("jive.utils.table")
 
 local System           = require("jive.System")
+local Framework        = require("jive.ui.Framework")
+local Timer            = require("jive.ui.Timer")
+
+local bundle           = jive.bundle
 
 local JIVE_VERSION     = jive.JIVE_VERSION
 local EVENT_ACTION     = jive.ui.EVENT_ACTION
@@ -62,8 +67,25 @@ local _sentinel = function () end
 local _services = {}
 
 local _defaultSettingsByAppletName = {}
+
+-- applets with settings to write, these are written once the settings
+-- have not changed for SETTINGS_QUIET ms, or SETTINGS_MAX_DELAY ms after
+-- the first change
+local SETTINGS_QUIET = 1000
+local SETTINGS_MAX_DELAY = 5000
+
+local _dirtySettings = {}
+local _dirtySince
+local _settingsTimer
 --work in progress-- local _overrideSettingsByAppletName = {}
 
+-- startup bundle, precompiled metas and pre-parsed strings. set _useBundle
+-- to false when editing applets in place, the bundle is only rebuilt when
+-- applets are added or removed
+local _useBundle = true
+local _bundle
+local _bundleStrings = {}	-- by locale
+
 -- allowed applets, can be used for debugging to limit applets loaded
 --[[
 local allowedApplets = {
@@ -88,6 +110,7 @@ function _initUserpathdir()
 	_userpathdir = System.getUserDir()
 	_usersettingsdir = _userpathdir .. "/settings"
 	_userappletsdir = _userpathdir .. "/applets"
+	_bundlepath = _userpathdir .. "/applets.bundle"
 	
 	log:info("User Path: ", _userpathdir)
 	
@@ -120,7 +143,7 @@ end
 
 -- _saveApplet
 -- creates entries for appletsDb, calculates paths and module names
-local function _saveApplet(name, dir)
+local function _saveApplet(name, dir, loadPriority)
 	log:debug("Found applet ", name, " in ", dir)
 	
 	if allowedApplets and not allowedApplets[name] then
@@ -153,22 +176,38 @@ local function _saveApplet(name, dir)
 			metaConfigured = false,
 			appletLoaded = false,
 			appletEvaluated = false,
-			loadPriority = _getLoadPriority(dir.. "/" .. name)
+			loadPriority = loadPriority or _getLoadPriority(dir.. "/" .. name)
 		}
 		_appletsDb[name] = newEntry
 	end
 end
 
 
+-- _appletDirs
+-- the applets directories on the lua path, the last entry of the path may
+-- not end with a ;
+local function _appletDirs()
+	local dirs = {}
+
+	for entry in package.path:gmatch("[^;]+") do
+		local dir = entry:match("^([^?]*)%?")
+		if dir then
+			dirs[#dirs + 1] = dir .. "applets"
+		end
+	end
+
+	return dirs
+end
+
+
 -- _findApplets
 -- find the available applets and store the findings in the appletsDb
 local function _findApplets()
 	log:debug("_findApplets")
 
 	-- Find all applets/* directories on lua path
-	for dir in package.path:gmatch("([^;]*)%?[^;]*;") do repeat
+	for _, dir in ipairs(_appletDirs()) do repeat
 	
-		dir = dir .. "applets"
 		log:debug("..in ", dir)
 		
 		local mode = lfs.attributes(dir, "mode")
@@ -193,6 +232,153 @@ local function _findApplets()
 end
 
 
+-- _bundleFingerprint
+-- identifies the applet tree the bundle was built from: the applets
+-- directories, for applets added or removed, and the modification time
+-- and size of each meta and strings file, as these are edited in place
+local function _bundleFingerprint()
+	local fingerprint = { JIVE_VERSION, package.path }
+
+	local function addFile(path)
+		local attr = lfs.attributes(path)
+		if attr then
+			fingerprint[#fingerprint + 1] = path .. "=" .. attr.modification .. "," .. attr.size
+		end
+	end
+
+	for _, dir in ipairs(_appletDirs()) do
+		local attr = lfs.attributes(dir)
+		if attr and attr.mode == "directory" then
+			fingerprint[#fingerprint + 1] = dir .. "=" .. attr.modification
+
+			for entry in lfs.dir(dir) do
+				if not entry:match("^%.") then
+					addFile(dir .. "/" .. entry .. "/" .. entry .. "Meta.lua")
+					addFile(dir .. "/" .. entry .. "/strings.txt")
+				end
+			end
+		end
+	end
+
+	return table.concat(fingerprint, "\n")
+end
+
+
+-- _openBundle
+-- reads the appletsDb from the startup bundle, if it is current
+local function _openBundle()
+	if not _useBundle or not bundle then
+		return false
+	end
+
+	local b = bundle.open(_bundlepath)
+	if not b then
+		return false
+	end
+
+	if b:fingerprint() ~= _bundleFingerprint() then
+		log:info("Startup bundle is stale")
+		b:close()
+		return false
+	end
+
+	local f, err = b:load("applets")
+	if not f then
+		log:warn("Error reading startup bundle: ", err)
+		b:close()
+		return false
+	end
+
+	local ok, applets = pcall(f)
+	if not ok then
+		log:warn("Error reading startup bundle: ", applets)
+		b:close()
+		return false
+	end
+
+	for i, applet in ipairs(applets) do
+		_saveApplet(applet.name, applet.dir, applet.loadPriority)
+		if _appletsDb[applet.name] then
+			_appletsDb[applet.name].bundled = true
+		end
+	end
+
+	f = b:load("locales")
+	if f then
+		locale:addLocales(f())
+	end
+
+	log:info("Using startup bundle ", _bundlepath)
+	_bundle = b
+	return true
+end
+
+
+-- _writeBundle
+-- writes the startup bundle for the applets found in the appletsDb
+local function _writeBundle()
+	if not _useBundle or not bundle then
+		return
+	end
+
+	local chunks = {}
+	local applets = {}
+	local strings = {}
+	local locales = {}
+
+	for name, entry in pairs(_appletsDb) do
+		local f, err = loadfile(entry.basename .. "Meta.lua")
+		if not f then
+			log:warn("Not bundling ", name, ": ", err)
+		else
+			applets[#applets + 1] = {
+				name = name,
+				dir = string.match(entry.dirpath, "^(.*)/" .. name .. "/$"),
+				loadPriority = entry.loadPriority,
+			}
+			chunks[#chunks + 1] = { "meta/" .. name, string.dump(f) }
+
+			-- strings for all locales, with the EN fallback applied
+			local allStrings = locale:loadAllStrings(entry.dirpath .. "strings.txt")
+			local fallback = allStrings["EN"] or {}
+
+			for lang, tokens in pairs(allStrings) do
+				if not strings[lang] then
+					strings[lang] = {}
+					locales[#locales + 1] = lang
+				end
+
+				local appletStrings = {}
+				for token, translation in pairs(fallback) do
+					appletStrings[token] = translation
+				end
+				for token, translation in pairs(tokens) do
+					appletStrings[token] = translation
+				end
+				strings[lang][name] = appletStrings
+			end
+		end
+	end
+
+	local function compile(value)
+		return string.dump(loadstring(dumper.dump(value, nil, true)))
+	end
+
+	chunks[#chunks + 1] = { "applets", compile(applets) }
+	chunks[#chunks + 1] = { "locales", compile(locales) }
+	for lang, appletStrings in pairs(strings) do
+		chunks[#chunks + 1] = { "strings/" .. lang, compile(appletStrings) }
+	end
+
+	local ok, err = bundle.write(_bundlepath, _bundleFingerprint(), chunks)
+	if not ok then
+		log:warn("Error writing startup bundle: ", err)
+	else
+		log:info("Wrote startup bundle ", _bundlepath)
+	end
+end
+
+
 -- _loadMeta
 -- loads the meta information of applet entry
 local function _loadMeta(entry)
@@ -205,7 +391,13 @@ local function _loadMeta(entry)
 		end
 		return p
 	end
-	local f, err = loadfile(entry.basename .. "Meta.lua")
+	local f, err
+	if entry.bundled and _bundle then
+		f = _bundle:load("meta/" .. entry.appletName)
+	end
+	if not f then
+		f, err = loadfile(entry.basename .. "Meta.lua")
+	end
 	if not f then
 		error (string.format ("error loading meta `%s' (%s)", entry.appletName, err))
 	end
@@ -382,6 +574,9 @@ local function _evalMetas()
 	-- trash them , we would need to store them here (to reload them if the applet ever runs)
 	-- because the meta might have changed them.
 
+	-- the pre-parsed strings are only needed while the metas load
+	_bundleStrings = {}
+
 	for name, entry in pairs(getSortedAppletDb(_appletsDb)) do
 		entry.metaObj = nil
 
@@ -399,7 +594,10 @@ end
 function discover(self)
 	log:debug("AppletManager:loadApplets")
 
-	_findApplets()
+	if not _openBundle() then
+		_findApplets()
+		_writeBundle()
+	end
 	_loadAndRegisterMetas()
 	_evalMetas()
 end
@@ -607,6 +805,22 @@ function _loadLocaleStrings(entry)
 	end
 
 	log:debug("_loadLocaleStrings: ", entry.appletName)
+
+	if entry.bundled and _bundle then
+		-- the locale can change between loads, so key by locale
+		local lang = locale:getLocale()
+		if _bundleStrings[lang] == nil then
+			local f = _bundle:load("strings/" .. lang)
+			_bundleStrings[lang] = f and f() or false
+		end
+
+		local strings = _bundleStrings[lang] and _bundleStrings[lang][entry.appletName]
+		if strings then
+			entry.stringsTable = locale:readStringsTable(entry.dirpath .. "strings.txt", strings)
+			return
+		end
+	end
+
 	entry.stringsTable = locale:readStringsFile(entry.dirpath .. "strings.txt")
 end
 
@@ -702,14 +916,52 @@ end
 
 
 -- _storeSettings
---
+-- marks the settings as changed, they are written in the background
+-- after a short quiet period
 function _storeSettings(entry)
 	assert(entry)
 
-	log:info("store settings: ", entry.appletName)
+	log:debug("settings changed: ", entry.appletName)
+
+	_dirtySettings[entry.appletName] = entry
+
+	if not _settingsTimer then
+		_settingsTimer = Timer(SETTINGS_QUIET, _writeSettings, true)
+	end
+
+	local now = Framework:getTicks()
+	if not _settingsTimer:isRunning() then
+		_dirtySince = now
+		_settingsTimer:start()
+	elseif now - _dirtySince < SETTINGS_MAX_DELAY then
+		_settingsTimer:restart()
+	end
+end
+
+
+-- _writeSettings
+--
+function _writeSettings()
+	for appletName, entry in pairs(_dirtySettings) do
+		log:info("store settings: ", appletName)
+
+		System:atomicWriteAsync(entry.settingsFilepath,
+			dumper.dump(entry.settings, "settings", true))
+	end
+
+	_dirtySettings = {}
+end
+
+
+-- flushSettings
+-- writes any changed settings now, and waits for them to be on disk
+function flushSettings(self)
+	if _settingsTimer then
+		_settingsTimer:stop()
+	end
 
-	System:atomicWrite(entry.settingsFilepath,
-		dumper.dump(entry.settings, "settings", true))
+	_writeSettings()
+	System:flushWrites()
 end
 
 
@@ -0,0 +1,421 @@
+
+--[[
+=head1 NAME
+
+jive.Bench - Headless rendering benchmark runner.
+
+=head1 DESCRIPTION
+
+Runs scripted UI scenarios against the selected skin with a virtual
+clock, and reports frame time percentiles for each phase of the frame
+from the frame telemetry. JiveMain runs this instead of the event loop
+when JIVE_BENCH is set. The SDL dummy video driver is used unless
+SDL_VIDEODRIVER is set.
+
+The collector is left running and stepped once a frame, as in the
+event loop, so the gc phase is the per frame step. The results say so
+in their gc field.
+
+Environment:
+
+ JIVE_BENCH            scenarios to run, comma separated, or "all"
+ JIVE_BENCH_SKIN       skin id to load, defaults to the selected skin
+ JIVE_BENCH_OUT        file for the JSON results, defaults to stdout
+ JIVE_BENCH_FRAMES     directory to save the captured frames as BMPs
+ JIVE_BENCH_GOLDEN     directory of golden frames to compare with
+ JIVE_BENCH_TOLERANCE  percentage of matching pixels required, default 100
+
+=head1 SYNOPSIS
+
+ JIVE_BENCH=all JIVE_BENCH_SKIN=JogglerSkin JIVE_BENCH_OUT=joggler.json jivelite
+
+=head1 FUNCTIONS
+
+=cut
+--]]
+
+local collectgarbage, ipairs, pairs, pcall, require, tonumber = collectgarbage, ipairs, pairs, pcall, require, tonumber
+
+local io            = require("io")
+local os            = require("os")
+local math          = require("math")
+local string        = require("string")
+local table         = require("jive.utils.table")
+
+local json          = require("cjson")
+
+local Framework     = require("jive.ui.Framework")
+local Event         = require("jive.ui.Event")
+local Group         = require("jive.ui.Group")
+local Icon          = require("jive.ui.Icon")
+local Label         = require("jive.ui.Label")
+local SimpleMenu    = require("jive.ui.SimpleMenu")
+local Surface       = require("jive.ui.Surface")
+local Task          = require("jive.ui.Task")
+local Timer         = require("jive.ui.Timer")
+local Window        = require("jive.ui.Window")
+
+local log           = require("jive.utils.log").logger("jivelite")
+
+local jiveMain      = jiveMain
+local jive          = jive
+
+local EVENT_SCROLL  = jive.ui.EVENT_SCROLL
+local FRAME_RATE    = jive.ui.FRAME_RATE
+
+-- frame phases from the frame telemetry, in microseconds
+local PHASES = { "layout", "animate", "background", "draw", "flip", "gc" }
+
+-- key colour for don't care pixels in golden frames
+local GOLDEN_KEY = 0xFF00FF
+
+
+module(...)
+
+
+-- run one frame, as the event loop does, with the clock advanced by
+-- exactly one frame
+local function _frame(self)
+	self.ticks = self.ticks + self.framerate
+	Framework:setVirtualClock(self.ticks)
+
+	local resumed = 0
+	for task in Task:iterator() do
+		task:resume()
+		resumed = resumed + 1
+	end
+
+	self.netTask:setArgs(0)
+	self.netTask:resume()
+
+	Framework:updateScreen()
+	Framework:_gcStep()
+
+	Timer:_runTimer(self.ticks)
+	self.eventTask:resume()
+
+	Framework:_commitFrameStats(resumed)
+end
+
+
+function frames(self, n)
+	for i = 1, n do
+		_frame(self)
+	end
+end
+
+
+function push(self, event)
+	Framework:pushEvent(event)
+end
+
+
+-- save the screen as label, and compare it with the golden frame
+function capture(self, label)
+	if not self.frameDir and not self.goldenDir then
+		return
+	end
+
+	local sw, sh = Framework:getScreenSize()
+	local srf = Surface:newRGB(sw, sh)
+	Framework:draw(srf)
+
+	local name = self.skin .. "_" .. self.scenario .. "_" .. label .. ".bmp"
+
+	if self.frameDir then
+		srf:saveBMP(self.frameDir .. "/" .. name)
+	end
+
+	if self.goldenDir then
+		local golden = Surface:loadImage(self.goldenDir .. "/" .. name)
+		local match = golden and srf:compare(golden, GOLDEN_KEY) or 0
+
+		self.golden[#self.golden + 1] = {
+			frame = name,
+			match = match,
+			ok = match >= self.tolerance,
+		}
+	end
+end
+
+
+-- a plain artwork image, so the runs do not depend on a server
+local function _artwork(size)
+	local srf = Surface:newRGB(size, size)
+
+	for i = 0, 15 do
+		local c = i * 16
+		srf:filledRectangle(0, i * size / 16, size, (i + 1) * size / 16,
+			c * 0x1000000 + (255 - c) * 0x10000 + 0x80 * 0x100 + 0xFF)
+	end
+
+	return srf
+end
+
+
+local scenarios = {}
+local order = { "home_scroll", "transitions", "nowplaying", "spectrum" }
+
+
+-- scroll down the home menu and back
+function scenarios.home_scroll(self)
+	jiveMain:goHome()
+	self:frames(30)
+
+	for i = 1, 40 do
+		self:push(Event:new(EVENT_SCROLL, 1))
+		self:frames(3)
+	end
+	self:capture("bottom")
+
+	for i = 1, 40 do
+		self:push(Event:new(EVENT_SCROLL, -1))
+		self:frames(3)
+	end
+	self:capture("top")
+end
+
+
+-- push a menu window and pop it again
+function scenarios.transitions(self)
+	for i = 1, 10 do
+		local window = Window("text_list", "Benchmark " .. i)
+		local menu = SimpleMenu("menu")
+
+		for j = 1, 20 do
+			menu:addItem({ text = "Item " .. j })
+		end
+		window:addWidget(menu)
+
+		window:show()
+		self:frames(5)
+		if i == 1 then
+			self:capture("push")
+		end
+		self:frames(15)
+
+		window:hide()
+		self:frames(20)
+	end
+end
+
+
+-- a now playing window with artwork and a running elapsed time
+function scenarios.nowplaying(self)
+	local window = Window("nowplaying")
+
+	local elapsed = Label("text", "0:00")
+
+	window:addWidget(Group("npartwork", { artwork = Icon("artwork", _artwork(300)) }))
+	window:addWidget(Group("nptrack", { nptrack = Label("nptrack", "Benchmark Track") }))
+	window:addWidget(Group("npalbum", { npalbum = Label("npalbum", "Benchmark Album") }))
+	window:addWidget(Group("npartist", { npartist = Label("npartist", "Benchmark Artist") }))
+	window:addWidget(Group("npprogressNB", { elapsed = elapsed }))
+
+	window:show()
+
+	for i = 1, 30 do
+		elapsed:setValue(string.format("%d:%02d", math.floor(i / 60), i % 60))
+		self:frames(FRAME_RATE / 2)
+	end
+	self:capture("artwork")
+
+	window:hide()
+	self:frames(20)
+end
+
+
+-- the spectrum meter, idle unless a visualizer writer is running
+function scenarios.spectrum(self)
+	local ok, SpectrumMeter = pcall(require, "jive.vis.SpectrumMeter")
+	if not ok then
+		return "skipped"
+	end
+
+	local window = Window("nowplaying_spectrum_text")
+	window:addWidget(Group("npvisu", { visu = SpectrumMeter("spectrum") }))
+
+	window:show()
+	self:frames(300)
+
+	window:hide()
+	self:frames(20)
+end
+
+
+local function _percentile(sorted, p)
+	if #sorted == 0 then
+		return 0
+	end
+	return sorted[math.max(1, math.ceil(#sorted * p / 100))]
+end
+
+
+local function _summary(values)
+	local sorted = {}
+	local sum = 0
+
+	for i, v in ipairs(values) do
+		sorted[i] = v
+		sum = sum + v
+	end
+	table.sort(sorted)
+
+	return {
+		p50 = _percentile(sorted, 50),
+		p90 = _percentile(sorted, 90),
+		p99 = _percentile(sorted, 99),
+		max = sorted[#sorted] or 0,
+		mean = #sorted > 0 and math.floor(sum / #sorted) or 0,
+	}
+end
+
+
+-- percentiles for each phase, and for the whole frame
+local function _report(stats)
+	local values = { total = {} }
+	for _, phase in ipairs(PHASES) do
+		values[phase] = {}
+	end
+
+	for i, s in ipairs(stats) do
+		local total = 0
+		for _, phase in ipairs(PHASES) do
+			values[phase][i] = s[phase]
+			total = total + s[phase]
+		end
+		values.total[i] = total
+	end
+
+	local phases = {}
+	for phase, v in pairs(values) do
+		phases[phase] = _summary(v)
+	end
+
+	return phases
+end
+
+
+--[[
+
+=head2 jive.Bench:run(netTask)
+
+Run the scenarios named in JIVE_BENCH, and write the results. Returns
+false if any golden frame did not match.
+
+=cut
+--]]
+function run(self, netTask)
+	local names = os.getenv("JIVE_BENCH")
+	if names == "all" or names == "1" or names == "" then
+		names = table.concat(order, ",")
+	end
+
+	local skin = os.getenv("JIVE_BENCH_SKIN")
+	if skin then
+		jiveMain:setSelectedSkin(skin)
+	end
+
+	local bench = {
+		netTask = netTask,
+		eventTask = Task("ui", Framework,
+			function(fw)
+				while fw:processEvents() do end
+			end),
+
+		framerate = math.floor(1000 / FRAME_RATE),
+		ticks = 0,
+
+		skin = jiveMain:getSelectedSkin() or "default",
+		frameDir = os.getenv("JIVE_BENCH_FRAMES"),
+		goldenDir = os.getenv("JIVE_BENCH_GOLDEN"),
+		tolerance = tonumber(os.getenv("JIVE_BENCH_TOLERANCE")) or 100,
+		golden = {},
+
+		frames = frames,
+		push = push,
+		capture = capture,
+	}
+
+	Framework:setUpdateScreen(true)
+	Framework:setVirtualClock(bench.ticks)
+
+	local sw, sh = Framework:getScreenSize()
+	local results = {
+		version = jive.JIVE_VERSION,
+		skin = bench.skin,
+		screen = { w = sw, h = sh },
+		frameRate = FRAME_RATE,
+		units = "usecs",
+		gc = "step",
+		scenarios = {},
+	}
+
+	-- start from a clean heap. the collector is not stopped, the
+	-- frame's gc step would restart it anyway
+	collectgarbage("collect")
+
+	-- settle after startup, the skin and home menu are laid out
+	bench:frames(FRAME_RATE)
+
+	for name in string.gmatch(names, "[^,%s]+") do
+		local scenario = scenarios[name]
+
+		if not scenario then
+			log:warn("unknown benchmark scenario: ", name)
+		else
+			log:info("benchmark: ", name)
+
+			bench.scenario = name
+			Framework:resetFrameStats()
+
+			local status = scenario(bench)
+			local stats = Framework:getFrameStats()
+
+			results.scenarios[#results.scenarios + 1] = {
+				name = name,
+				status = status or "ok",
+				frames = #stats,
+				phases = _report(stats),
+			}
+		end
+	end
+
+	Framework:setVirtualClock(nil)
+
+	local ok = true
+	if bench.goldenDir then
+		results.golden = bench.golden
+		for _, g in ipairs(bench.golden) do
+			ok = ok and g.ok
+		end
+	end
+
+	local out = json.encode(results)
+	local file = os.getenv("JIVE_BENCH_OUT")
+	if file then
+		local fh = io.open(file, "w")
+		if fh then
+			fh:write(out, "\n")
+			fh:close()
+		else
+			log:error("cannot write ", file)
+		end
+	else
+		io.write(out, "\n")
+	end
+
+	return ok
+end
+
+
+--[[
+
+=head1 LICENSE
+
+Copyright 2010 Logitech. All Rights Reserved.
+
+This file is licensed under BSD. Please see the LICENSE file for details.
+
+=cut
+--]]
@@ -382,6 +382,21 @@ function JiveMain:__init()
 	-- debug: set event warning thresholds (0 = off)
 	--Framework:perfwarn({ screen = 50, layout = 1, draw = 0, event = 50, queue = 5, garbage = 10 })
 	--jive.perfhook(50)
+	-- debug: sample the lua stack at 100Hz, later jive.profileStop() and jive.profileDump(file) to write folded stacks
+	--jive.profileStart(100)
+
+	-- headless benchmark runs replace the splash and event loop
+	if os.getenv("JIVE_BENCH") then
+		JiveMain:performPostOnScreenInit()
+
+		local ok = require("jive.Bench"):run(jnt:task())
+
+		-- settings are written in the background, make sure they are on disk
+		appletManager:flushSettings()
+
+		Framework:quit()
+		os.exit(ok and 0 or 1)
+	end
 
 	-- show splash screen for five seconds, or until key/scroll events
 	Framework:setUpdateScreen(false)
@@ -400,29 +415,70 @@ function JiveMain:__init()
 		true)
 	splashTimer:start()
 
+	-- incremental heap snapshots, diffed against the previous snapshot
+	local heapSnapshot, heapTypes, heapStepTimer
+	heapStepTimer = Timer(100,
+		function()
+			local snapshot = jive.heapSnapshotStep(5)
+			if not snapshot then
+				return
+			end
+			heapStepTimer:stop()
+
+			if heapSnapshot then
+				local growth = {}
+				for key, delta in pairs(jive.heapDiff(heapSnapshot, snapshot)) do
+					growth[#growth + 1] = { key = key, count = delta.count, size = delta.size }
+				end
+				table.sort(growth, function(a, b) return a.count > b.count end)
+
+				logheap:debug("--- HEAP growth type/class/owner count/size ---")
+				for i = 1, math.min(#growth, 20) do
+					logheap:debug(growth[i].key, " ", growth[i].count, "/", growth[i].size)
+				end
+			end
+
+			-- totals by type, in place of a blocking walk of the whole heap
+			local types = {}
+			for key, count in pairs(snapshot.count) do
+				local t = string.match(key, "^[^/]+")
+				local total = types[t] or { count = 0, size = 0 }
+				total.count = total.count + count
+				total.size = total.size + (snapshot.size[key] or 0)
+				types[t] = total
+			end
+
+			logheap:debug("--- HEAP type count/size (change) ---")
+			for t, total in pairs(types) do
+				local last = heapTypes and heapTypes[t]
+				local change = heapTypes and total.count - (last and last.count or 0) or 0
+				logheap:debug(t, "=", total.count, "/", total.size, " (", change, ")")
+			end
+
+			logheap:debug("objects=", snapshot.objects)
+			heapSnapshot = snapshot
+			heapTypes = types
+		end)
+
 	local heapTimer = Timer(60000,
 		function()
 			if not logheap:isDebug() then
 				return
 			end
 
-			local s = jive.heap()
-			logheap:debug("--- HEAP total/new/free ---")
-			logheap:debug("number=", s["number"]);
-			logheap:debug("integer=", s["integer"]);
-			logheap:debug("boolean=", s["boolean"]);
-			logheap:debug("string=", s["string"]);
-			logheap:debug("table=", s["table"], "/", s["new_table"], "/", s["free_table"]);
-			logheap:debug("function=", s["function"], "/", s["new_function"], "/", s["free_function"]);
-			logheap:debug("thread=", s["thread"], "/", s["new_thread"], "/", s["free_thread"]);
-			logheap:debug("userdata=", s["userdata"], "/", s["new_userdata"], "/", s["free_userdata"]);
-			logheap:debug("lightuserdata=", s["lightuserdata"], "/", s["new_lightuserdata"], "/", s["free_lightuserdata"]);
+			if not heapStepTimer:isRunning() then
+				jive.heapSnapshot()
+				heapStepTimer:start()
+			end
 		end)
 	heapTimer:start()
 
 	-- run event loop
 	Framework:eventLoop(jnt:task())
 
+	-- settings are written in the background, make sure they are on disk
+	appletManager:flushSettings()
+
 	Framework:quit()
 
 --	profiler.stop()
@@ -33,6 +33,19 @@ Return the user-specific path that holds settings, 3rd-party applets, wallpaper,
 
 Find a file on the lua path. Returns the full path of the file, or nil if it was not found.
 
+=head2 System:atomicWrite(path, data)
+
+Write I<data> to the file I<path>, replacing it atomically once the new data is on disk.
+
+=head2 System:atomicWriteAsync(path, data)
+
+As atomicWrite, but the file is written by a background thread. If the file is queued again before
+it has been written only the latest I<data> is written. Pending writes are finished on exit.
+
+=head2 System:flushWrites()
+
+Wait until all background writes are on disk.
+
 --]]
 local tonumber, tostring, type, pairs = tonumber, tostring, type, pairs
 
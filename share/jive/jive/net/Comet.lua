@@ -27,6 +27,7 @@ This class implements a HTTP socket running in a L<jive.net.NetworkThread>.
  -- send a non-subscription request
  -- playerid may be nil
  -- request is a table (array) containing the raw request to pass to SlimServer
+ -- returns the reqid, a handle for removeRequest
  comet:request(func, playerid, request)
 
  -- add a callback function for an already-subscribed event
@@ -47,6 +48,13 @@ This class implements a HTTP socket running in a L<jive.net.NetworkThread>.
   comet:request(...)
   comet:endBatch()
 
+ -- calls made outside a batch are coalesced and sent together on the
+ -- next timer pass, or after a window in ms, false sends immediately
+ comet:setCoalesceWindow(50)
+
+ -- batches sent, messages sent, duplicate queries merged, largest batch
+ local stats = comet:getBatchStats()
+
 =head1 FUNCTIONS
 
 =cut
@@ -57,7 +65,7 @@ This class implements a HTTP socket running in a L<jive.net.NetworkThread>.
 
 
 -- stuff we use
-local assert, ipairs, table, pairs, string, tonumber, tostring = assert, ipairs, table, pairs, string, tonumber, tostring
+local assert, ipairs, next, table, pairs, string, tonumber, tostring, type = assert, ipairs, next, table, pairs, string, tonumber, tostring, type
 
 local oo            = require("loop.simple")
 local math          = require("math")
@@ -78,6 +86,16 @@ local JIVE_VERSION  = jive.JIVE_VERSION
 -- times are in ms
 local RETRY_DEFAULT = 5000  -- default delay time to retry connection (5s)
 local MAX_BACKOFF   = 60000 -- don't wait longer than this before retrying (60s)
+local COALESCE_DEFAULT = 0  -- send coalesced requests on the next timer pass
+
+-- read only commands, identical requests in flight share one response
+local QUERY_COMMANDS = {
+	albums = true, artists = true, genres = true, years = true,
+	titles = true, tracks = true, songs = true, playlists = true,
+	musicfolder = true, songinfo = true, trackinfo = true, status = true,
+	serverstatus = true, players = true, contextmenu = true,
+	artistinfo = true, albuminfo = true, browselibrary = true,
+}
 
 -- jive.net.Comet is a base class
 module(..., oo.class)
@@ -86,6 +104,10 @@ module(..., oo.class)
 -- forward declarations
 local _addPendingRequests
 local _sendPendingRequests
+local _scheduleSend
+local _queryKey
+local _queryDone
+local _copy
 local _state
 local _handshake
 local _getHandshakeSink
@@ -144,16 +166,31 @@ function __init(self, jnt, name)
 	obj.advice         = {}       -- advice from server on how to handle reconnects
 	obj.failures       = 0        -- count of connection failures
 	obj.batch          = 0        -- are we batching queries?
+	obj.coalesce       = COALESCE_DEFAULT -- window to gather requests in, or false
 	
 	obj.subs           = {}       -- all subscriptions
 	obj.pending_unsubs = {}       -- pending unsubscribe requests
 	obj.pending_reqs   = {}       -- pending requests to send with connect
 	obj.sent_reqs      = {}       -- sent requests, awaiting a response
 	obj.notify         = {}       -- callbacks to notify
+	obj.queries        = {}       -- query key to reqid, for queries awaiting a response
+	obj.query_keys     = {}       -- reqid to query key
+	obj.query_refs     = {}       -- reqid to the number of callers sharing the query
+	obj.merged         = {}       -- merged caller's reqid to the query's reqid
+
+	-- batches sent, messages in them, duplicate queries merged
+	obj.stats          = { batches = 0, messages = 0, merged = 0, largest = 0 }
 
 	-- Reconnection timer
 	obj.reconnect_timer = Timer(0, function() _handleTimer(obj) end, true)
 
+	-- Timer to send coalesced requests
+	obj.coalesce_timer = Timer(0, function()
+		if obj.state == CONNECTED and obj.batch == 0 then
+			_sendPendingRequests(obj)
+		end
+	end, true)
+
 	-- Subscribe to networkConnected events, which happen if we change wireless networks
 	jnt:subscribe(obj)
 	
@@ -328,12 +365,13 @@ _addPendingRequests = function(self, data)
 		if v.func then
 			req.id = v.reqid
 				
-			-- Store this request's callback
+			-- Store this request's callback, by reqid as merged
+			-- requests add theirs by their own reqid
 			local subscription = '/slim/request|' .. v.reqid
 			if not self.notify[subscription] then
 				self.notify[subscription] = {}
 			end
-			self.notify[subscription][v.func] = v.func
+			self.notify[subscription][v.reqid] = v.func
 
 			table.insert( self.sent_reqs, req )
 		end
@@ -346,6 +384,65 @@ _addPendingRequests = function(self, data)
 end
 
 
+-- Send pending requests after the coalesce window, so requests made
+-- together go in one batch
+_scheduleSend = function(self)
+	if not self.coalesce then
+		_sendPendingRequests(self)
+
+	elseif not self.coalesce_timer:isRunning() then
+		self.coalesce_timer:restart(self.coalesce)
+	end
+end
+
+
+-- Key for a read only request, or nil if the request has side effects
+_queryKey = function(playerid, request, priority)
+	local cmd = request[1]
+	if not (QUERY_COMMANDS[cmd] or request[2] == 'items') then
+		return nil
+	end
+
+	local key = { playerid or '', priority or '' }
+	for i, v in ipairs(request) do
+		key[#key + 1] = tostring(v)
+	end
+
+	return table.concat(key, '|')
+end
+
+
+-- A query has been answered or dropped, later requests are sent again
+_queryDone = function(self, reqid)
+	local key = self.query_keys[reqid]
+	if key then
+		self.queries[key] = nil
+		self.query_keys[reqid] = nil
+		self.query_refs[reqid] = nil
+
+		for id, queryid in pairs(self.merged) do
+			if queryid == reqid then
+				self.merged[id] = nil
+			end
+		end
+	end
+end
+
+
+-- Deep copy of a response, for callbacks sharing a merged query
+_copy = function(v)
+	if type(v) ~= 'table' then
+		return v
+	end
+
+	local t = {}
+	for k, x in pairs(v) do
+		t[k] = _copy(x)
+	end
+	return t
+end
+
+
 -- Send any pending subscriptions and requests
 _sendPendingRequests = function(self, data)
 
@@ -357,6 +454,13 @@ _sendPendingRequests = function(self, data)
 	
 	-- Only continue if we have some data to send
 	if data[1] then
+		local stats = self.stats
+		stats.batches = stats.batches + 1
+		stats.messages = stats.messages + #data
+		stats.largest = math.max(stats.largest, #data)
+
+		log:debug(self, ": sending batch of ", #data)
+
 		if log:isDebug() then
 			log:debug("Sending pending request(s):")
 			debug.dump(data, 5)
@@ -399,13 +503,13 @@ function subscribe(self, subscription, func, playerid, request, priority)
 	-- Bump reqid for the next request
 	self.reqid = id + 1
 
-	-- Send immediately unless we're batching queries
+	-- Send soon unless we're batching queries
 	if self.state ~= CONNECTED or self.batch ~= 0 then
 		return
 	end
 
 	-- Send all pending requests and subscriptions
-	_sendPendingRequests(self)
+	_scheduleSend(self)
 end
 
 
@@ -447,13 +551,13 @@ function unsubscribe(self, subscription, func)
 	-- Bump reqid for the next request
 	self.reqid = id + 1
 
-	-- Send immediately unless we're batching queries
+	-- Send soon unless we're batching queries
 	if self.state ~= CONNECTED or self.batch ~= 0 then
 		return
 	end
 
 	-- Send all pending requests
-	_sendPendingRequests(self)
+	_scheduleSend(self)
 end
 
 
@@ -469,6 +573,36 @@ function request(self, func, playerid, request, priority)
 		log:debug(self, ": request(", func, ", reqid:", id, ", ", playerid, ", ", table.concat(_request, ","), ", priority:", priority, ")")
 	end
 
+	-- An identical query is waiting for its response, share it
+	local key = func and _queryKey(playerid, request, priority)
+	if key and self.queries[key] then
+		local queryid = self.queries[key]
+		log:debug(self, ": request reqid:", id, " merged with reqid:", queryid)
+
+		-- the caller still gets its own reqid, the query is only
+		-- dropped when the last caller sharing it is removed
+		local subscription = '/slim/request|' .. queryid
+		if not self.notify[subscription] then
+			self.notify[subscription] = {}
+		end
+		self.notify[subscription][id] = func
+
+		self.merged[id] = queryid
+		self.query_refs[queryid] = self.query_refs[queryid] + 1
+
+		-- Bump reqid for the next request
+		self.reqid = id + 1
+
+		self.stats.merged = self.stats.merged + 1
+		return id
+	end
+
+	if key then
+		self.queries[key] = id
+		self.query_keys[id] = key
+		self.query_refs[id] = 1
+	end
+
 	-- Add to pending requests
 	table.insert(self.pending_reqs, {
 		reqid = id,
@@ -488,7 +622,7 @@ function request(self, func, playerid, request, priority)
 		_reconnect(self)
 	end
 
-	-- Send immediately unless we're batching queries
+	-- Send soon unless we're batching queries
 	if self.state ~= CONNECTED or self.batch ~= 0 then
 		if self.state ~= CONNECTED then
 			self.jnt:notify('cometDisconnected', self, self.idleTimeoutTriggered)
@@ -499,7 +633,7 @@ function request(self, func, playerid, request, priority)
 	end
 
 	-- Send all pending requests
-	_sendPendingRequests(self)
+	_scheduleSend(self)
 
 	return id
 end
@@ -523,6 +657,20 @@ function removeCallback(self, subscription, func)
 end
 
 
+-- Set the window in ms to gather requests into one batch, 0 sends on the
+-- next timer pass and false sends each request immediately
+function setCoalesceWindow(self, coalesce)
+	self.coalesce = coalesce
+end
+
+
+-- Returns the number of batches and messages sent, the number of
+-- duplicate queries merged and the largest batch
+function getBatchStats(self)
+	return self.stats
+end
+
+
 -- Begin a set of batched queries
 function startBatch(self)
 	log:debug(self, ": startBatch ", self.batch)
@@ -545,6 +693,7 @@ function endBatch(self)
 	end
 
 	-- Send all pending requests and subscriptions
+	self.coalesce_timer:stop()
 	_sendPendingRequests(self)
 end
 
@@ -843,17 +992,44 @@ function removeRequest(self, requestId)
 		return false
 	end
 
+	-- a merged query is shared, other callers still want the response
+	local queryid = self.merged[requestId] or requestId
+	local refs = self.query_refs[queryid]
+	if refs and refs > 1 then
+		self.query_refs[queryid] = refs - 1
+		self.merged[requestId] = nil
+
+		local callbacks = self.notify['/slim/request|' .. queryid]
+		if callbacks then
+			callbacks[requestId] = nil
+		end
+
+		-- the first caller's callback is still waiting to be sent
+		if requestId == queryid then
+			for i, request in ipairs( self.pending_reqs ) do
+				if request.reqid == queryid then
+					request.func = function() end
+					break
+				end
+			end
+		end
+
+		return true
+	end
+
 	--try both sent and pending, since request may have been sent prior to knowing server was down
 	for i, request in ipairs( self.sent_reqs ) do
-		if request.id == requestId then
+		if request.id == queryid then
 			table.remove( self.sent_reqs, i )
+			_queryDone(self, queryid)
 			return true
 		end
 	end
 
 	for i, request in ipairs( self.pending_reqs ) do
-		if request.reqid == requestId then
+		if request.reqid == queryid then
 			table.remove( self.pending_reqs, i )
+			_queryDone(self, queryid)
 			return true
 		end
 	end
@@ -950,14 +1126,20 @@ _response = function(self, chunk)
 			if self.notify[subscription] then
 				log:debug(self, ": _response, notifiying callbacks for ", subscription)
 				
-				for _, func in pairs( self.notify[subscription] ) do
+				-- callbacks sharing a merged query each get their own
+				-- copy, so one can't change the response under another
+				local callbacks = self.notify[subscription]
+				local shared = onetime_request and next(callbacks, next(callbacks)) ~= nil
+
+				for _, func in pairs( callbacks ) do
 					log:debug("  callback to: ", func)
-					func(event)
+					func(shared and _copy(event) or event)
 				end
 						
 				if onetime_request then
 					-- this was a one-time request, so remove the callback
 					self.notify[subscription] = nil
+					_queryDone(self, tonumber(event.id))
 				end
 			else
 				-- this is normal, since unsub's are delayed by a few seconds, we may receive events
@@ -981,6 +1163,10 @@ _disconnect = function(self)
 	assert(self.state == CONNECTED)
 
 	log:debug(self, ': disconnect()')
+
+	-- Send anything still waiting for the coalesce window
+	self.coalesce_timer:stop()
+	_sendPendingRequests(self)
 		
 	-- Mark all subs as pending so they can be resubscribed later
 	for i, v in ipairs( self.subs ) do
@@ -991,6 +1177,10 @@ _disconnect = function(self)
 	-- As we are disconnecting we no longer care about waiting for
 	-- a reply from the sent requests
 	self.sent_reqs = {}
+	self.queries = {}
+	self.query_keys = {}
+	self.query_refs = {}
+	self.merged = {}
 
 	local data = { {
 		channel  = '/meta/disconnect',
@@ -20,6 +20,8 @@ Notifications:
  playerNew (performed by SlimServer)
  playerDelete (performed by SlimServer)
  playerTrackChange
+ playerPositionChange (elapsed time jumped, or the duration changed, with elapsed and duration)
+ playerVolumeChange
  playerModeChange
  playerPlaylistChange
  playerShuffleModeChange
@@ -81,6 +83,13 @@ local iconbar        = iconbar
 local fmt = string.format
 
 local MIN_KEY_INT    = 150  -- sending key rate limit in ms
+local POSITION_JUMP  = 2    -- elapsed time drift in seconds reported as a seek
+
+-- playerstatus fields copied to the player info
+local PLAYER_INFO_FIELDS = {
+	"player_name", "digital_volume_control", "use_volume_control", "player_connected",
+	"power", "player_needs_upgrade", "player_is_upgrading", "seq_no",
+}
 
 -- jive.slim.Player is a base class
 module(..., oo.class)
@@ -1150,6 +1159,27 @@ function updateIconbar(self)
 end
 
 
+-- _changedFields
+-- returns a set of the scalar fields that differ between two playerstatus
+-- tables, tables such as item_loop are compared by the caller
+local function _changedFields(old, new)
+	local changed = {}
+
+	for k, v in pairs(new) do
+		if type(v) ~= "table" and old[k] ~= v then
+			changed[k] = true
+		end
+	end
+	for k, v in pairs(old) do
+		if new[k] == nil and type(v) ~= "table" then
+			changed[k] = true
+		end
+	end
+
+	return changed
+end
+
+
 -- _process_status
 -- processes the playerstatus data and calls associated functions for notification
 function _process_status(self, event)
@@ -1159,10 +1189,19 @@ function _process_status(self, event)
 		-- ignore player status sent with an error
 		return
 	end
-	-- update our state in one go
+
+	-- where we expect the track to be, before taking the new position
+	local expectedElapsed = self:getTrackElapsed()
+
+	--Ignore fractional component of volume
+	event.data["mixer volume"] = event.data["mixer volume"] and math.floor(tonumber(event.data["mixer volume"])) or nil
+
+	-- update our state in one go, most updates only change the elapsed time
 	local oldState = self.state
 	self.state = event.data
 
+	local changed = _changedFields(oldState, self.state)
+
 
 	-- used for calculating getTrackElapsed(), getTrackRemaining()
 	self.rate = tonumber(event.data.rate)
@@ -1182,43 +1221,36 @@ function _process_status(self, event)
 	-- Bug 15814: flag for when the audio hasn't started streaming yet but mode is play
 	self.waitingToPlay = event.data.waitingToPlay or false
 
-	-- update our player state, and send notifications
-	-- create a playerInfo table, to allow code reuse
-	local playerInfo = {}
-	playerInfo.uuid = self.info.uuid
-	playerInfo.name = event.data.player_name
-	playerInfo.digital_volume_control = event.data.digital_volume_control
-	playerInfo.use_volume_control = event.data.use_volume_control
-	playerInfo.model = self.info.model
-	playerInfo.connected = event.data.player_connected
-	playerInfo.power = event.data.power
-	playerInfo.player_needs_upgrade = event.data.player_needs_upgrade
-	playerInfo.player_is_upgrading = event.data.player_is_upgrading
-	playerInfo.pin = self.info.pin
-	playerInfo.seq_no = event.data.seq_no
-
-	local useSequenceNumber = false
+	local useSequenceNumber = self:isLocal() and event.data.seq_no ~= nil
 	local isSequenceNumberInSync = true
 
-	if self:isLocal() and playerInfo.seq_no then
-		useSequenceNumber = true
-		if not self:isSequenceNumberInSync(tonumber(playerInfo.seq_no)) then
+	if useSequenceNumber then
+		if not self:isSequenceNumberInSync(tonumber(event.data.seq_no)) then
 			isSequenceNumberInSync = false
 		end
 	end
-	self:updatePlayerInfo(self.slimServer, playerInfo, useSequenceNumber, isSequenceNumberInSync)
+
+	-- update our player state, and send notifications, when the player info
+	-- fields have changed, or the server is being refreshed
+	local infoChanged = self.serverRefreshInProgress or self.slimServer == nil
+	for _, field in ipairs(PLAYER_INFO_FIELDS) do
+		infoChanged = infoChanged or changed[field]
+	end
+
+	if infoChanged then
+		self:_updateStatusInfo(event.data, useSequenceNumber, isSequenceNumberInSync)
+	end
 
 	-- update track list
 	local nowPlaying, artwork = _whatsPlaying(event.data)
 
-	if self.state.mode ~= oldState.mode then
+	if changed.mode then
 		-- self.mode is set immedidately by togglePause and stop methods to give immediate user feedback in e.g. iconbar
 		-- getPlayerMode method uses self.mode not self.state.mode, so we need to set self.mode again here to be certain it's correct                                          
 		log:debug('notify_playerModeChange')
 		self.mode = self.state.mode
 		self.jnt:notify('playerModeChange', self, self.state.mode)
 	end
-
 	log:debug("self.state['alarm_state']: ", self.state['alarm_state'], ",  oldState['alarm_state']: ", oldState['alarm_state'])
 	log:debug("self.state['alarm_next']: ", self.state['alarm_next'], ",  oldState['alarm_next']: ", oldState['alarm_next'])
 
@@ -1227,12 +1259,12 @@ function _process_status(self, event)
 	log:debug("self.state['alarm_repeat']: ", self.state['alarm_repeat'], ",  oldState['alarm_repeat']: ", oldState['alarm_repeat'])
 	log:debug("self.state['alarm_days']: ", self.state['alarm_days'], ",  oldState['alarm_days']: ", oldState['alarm_days'])
 
-	if self.state['alarm_state'] ~= oldState['alarm_state'] or
-	   self.state['alarm_next'] ~= oldState['alarm_next'] or
-	   self.state['alarm_version'] ~= oldState['alarm_version'] or
-	   self.state['alarm_next2'] ~= oldState['alarm_next2'] or
-	   self.state['alarm_repeat'] ~= oldState['alarm_repeat'] or
-	   self.state['alarm_days'] ~= oldState['alarm_days'] then
+	if changed['alarm_state'] or
+	   changed['alarm_next'] or
+	   changed['alarm_version'] or
+	   changed['alarm_next2'] or
+	   changed['alarm_repeat'] or
+	   changed['alarm_days'] then
 		log:debug('notify_playerAlarmState')
 		-- none from server for alarm_state changes this to nil
 		if self.state['alarm_state'] == 'none' then
@@ -1253,35 +1285,42 @@ function _process_status(self, event)
 
 	end
 
-	if self.state['playlist shuffle'] ~= oldState['playlist shuffle'] then
+	if changed['playlist shuffle'] then
 		log:debug('notify_playerShuffleModeChange')
 		self.jnt:notify('playerShuffleModeChange', self, self.state['playlist shuffle'])
 	end
 
-	if self.state['sleep'] ~= oldState['sleep'] then
+	if changed['sleep'] then
 		log:debug('notify_playerSleepChange')
 		self.jnt:notify('playerSleepChange', self, self.state['sleep'])
 	end
 
-	if self.state['playlist repeat'] ~= oldState['playlist repeat'] then
+	if changed['playlist repeat'] then
 		log:debug('notify_playerRepeatModeChange')
 		self.jnt:notify('playerRepeatModeChange', self, self.state['playlist repeat'])
 	end
 
-	if self.nowPlaying ~= nowPlaying or self.nowPlayingArtwork ~= artwork then
+	local trackChanged = self.nowPlaying ~= nowPlaying or self.nowPlayingArtwork ~= artwork
+	if trackChanged then
 		log:debug('notify_playerTrackChange')
 		self.nowPlaying = nowPlaying
 		self.nowPlayingArtwork = artwork
 		self.jnt:notify('playerTrackChange', self, nowPlaying, artwork)
 	end
 
-	if self.state.playlist_timestamp ~= oldState.playlist_timestamp then
+	if changed.playlist_timestamp then
 		log:debug('notify_playerPlaylistChange')
 		self.jnt:notify('playerPlaylistChange', self)
 	end
 
-	--Ignore fractional component of volume
-	self.state["mixer volume"] = self.state["mixer volume"] and math.floor(tonumber(self.state["mixer volume"])) or nil
+	-- a new track redraws everything, otherwise only report the position
+	-- when it is not where the elapsed time says it should be
+	if not trackChanged and (changed.duration or changed.rate or
+		(self.trackTime and expectedElapsed and math.abs(self.trackTime - expectedElapsed) > POSITION_JUMP)) then
+		log:debug('notify_playerPositionChange')
+		local elapsed = self:getTrackElapsed()
+		self.jnt:notify('playerPositionChange', self, elapsed, self.trackDuration)
+	end
 
 	--might use server volume
 	if useSequenceNumber then
@@ -1310,10 +1349,36 @@ function _process_status(self, event)
 			self:refreshLocallyMaintainedParameters()
 		end
 	end
+
+	if self.state["mixer volume"] ~= oldState["mixer volume"] then
+		log:debug('notify_playerVolumeChange')
+		self.jnt:notify('playerVolumeChange', self, self.state["mixer volume"])
+	end
+
 	-- update iconbar
 	self:updateIconbar()
 end
 
+
+-- _updateStatusInfo
+-- create a playerInfo table from the playerstatus data, to allow code reuse
+function _updateStatusInfo(self, data, useSequenceNumber, isSequenceNumberInSync)
+	local playerInfo = {}
+	playerInfo.uuid = self.info.uuid
+	playerInfo.name = data.player_name
+	playerInfo.digital_volume_control = data.digital_volume_control
+	playerInfo.use_volume_control = data.use_volume_control
+	playerInfo.model = self.info.model
+	playerInfo.connected = data.player_connected
+	playerInfo.power = data.power
+	playerInfo.player_needs_upgrade = data.player_needs_upgrade
+	playerInfo.player_is_upgrading = data.player_is_upgrading
+	playerInfo.pin = self.info.pin
+	playerInfo.seq_no = data.seq_no
+
+	self:updatePlayerInfo(self.slimServer, playerInfo, useSequenceNumber, isSequenceNumberInSync)
+end
+
 function _alertWindow(self, title, textValue)
 
 	local showMe = true
@@ -881,8 +881,22 @@ end
 
 -- convert artwork to a resized image
 local function _loadArtworkImage(self, cacheKey, chunk, size)
-	-- create a surface
-	local image = Surface:loadImageData(chunk, #chunk)
+	-- parse size specification for width and height if in format <W>x<H>
+	local sizeW = tonumber(string.match(size, "(%d+)x%d+") or size)
+	local sizeH = tonumber(string.match(size, "%d+x(%d+)") or size)
+
+	-- create a surface, resized unless it already has the width or height.
+	-- Note this allows for artwork to be resized to a larger
+	-- size than the original.  This is intentional so smaller cover
+	-- art will still fill the space properly on the Now Playing screen.
+	-- The decoded image is shared with other servers loading the same artwork
+	local image = Surface:loadImageData(chunk, #chunk, sizeW, sizeH)
+
+	-- not decoded, or not resized
+	if not image then
+		self.imageCache[cacheKey] = true
+		return nil
+	end
 
 	local w, h = image:getSize()
 
@@ -892,22 +906,8 @@ local function _loadArtworkImage(self, cacheKey, chunk, size)
 		return nil
 	end
 
-	-- parse size specification for width and height if in format <W>x<H>
-	local sizeW = tonumber(string.match(size, "(%d+)x%d+") or size)
-	local sizeH = tonumber(string.match(size, "%d+x(%d+)") or size)
-
-	-- Resize image
-	-- Note this allows for artwork to be resized to a larger
-	-- size than the original.  This is intentional so smaller cover
-	-- art will still fill the space properly on the Now Playing screen
-	if w ~= sizeW and h ~= sizeH then
-		local tmp = image:resize(sizeW, sizeH, true)
-		image:release()
-		image = tmp
-		if logcache:isDebug() then
-			local wnew, hnew = image:getSize()
-			logcache:debug("Resized artwork from ", w, "x", h, " to ", wnew, "x", hnew)
-		end
+	if logcache:isDebug() then
+		logcache:debug("Loaded artwork at ", w, "x", h, " for ", size)
 	end
 
 	-- cache image
@@ -142,6 +142,10 @@ Dispatch an event I<event> to the listeners of the widget I<widget>. Any global
 
 Return the number of milliseconds since the Jive initialization.
 
+=head2 jive.ui.Framework:setVirtualClock(ticks)
+
+Use a virtual clock set to I<ticks> for getTicks(), or the real clock again if I<ticks> is nil. The virtual clock only moves when it is set, the benchmark runner uses this to make timers and animations repeatable.
+
 =head2 jive.ui.Framework:threadTicks()
 
 Return the number of milliseconds spent in current thread.  Note this is lower resolution than getTicks().
@@ -158,6 +162,18 @@ Sets the background image I<image>.
 
 Indicates the style parameters have changed, this clears any caching of the style values used.
 
+=head2 jive.ui.Framework:getFrameStats(n)
+
+Returns a table of the telemetry for the last I<n> frames (or all recorded frames if I<n> is nil), oldest first. Each entry has the fields I<ticks>, I<layout>, I<animate>, I<background>, I<draw>, I<flip> and I<gc> (times in microseconds), I<dirty> (pixels redrawn), I<pixels> (pixels presented), I<events> and I<tasks>.
+
+=head2 jive.ui.Framework:dumpFrameStats(path, format)
+
+Writes the recorded frame telemetry to the file I<path>, either as "csv" (the default) or "bin". Returns the number of frames written, or nil and an error message.
+
+=head2 jive.ui.Framework:resetFrameStats()
+
+Clears the recorded frame telemetry.
+
 =cut
 --]]
 
@@ -315,6 +331,9 @@ function eventLoop(self, netTask)
 	local now = self:getTicks()
 	local framedue = now + framerate
 
+	-- tasks resumed this frame, for the frame telemetry
+	local resumed = 0
+
 	local running = true
 	while running do
 		-- process tasks: 
@@ -323,6 +342,7 @@ function eventLoop(self, netTask)
 		for task in Task:iterator() do
 			local start = now
 			tasks = task:resume() or tasks
+			resumed = resumed + 1
 			now = self:getTicks()
 			if now - start > 20 then
 				log:debug(task.name, " took ", now - start, " ms")
@@ -351,12 +371,15 @@ function eventLoop(self, netTask)
 			self:updateScreen()
 
 			-- keep on top of the garbage
-			collectgarbage("step")
+			self:_gcStep()
 
 			-- process ui event once per frame
 			Timer:_runTimer(now)
 			running = eventTask:resume()
 
+			self:_commitFrameStats(resumed)
+			resumed = 0
+
 			-- when is the next frame due?
 			framedue = framedue + framerate
 
@@ -1177,7 +1200,7 @@ function setGlobalSetting(self, key, value)
 
 	self._global_settings[key] = value
 
-	System:atomicWrite(global_settings_file,
+	System:atomicWriteAsync(global_settings_file,
 		dumper.dump(self._global_settings, "global_settings", true))
 end
 
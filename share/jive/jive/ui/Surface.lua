@@ -33,9 +33,46 @@ Constructs a new RGBA surface of width and height I<w> and I<h>. The surface is
 
 Load an image from I<path>. If I<path> is relative the lua path is searched for the image. Returns the loaded image.
 
-=head2 loadImageData(data, len)
+=head2 loadImageData(data, len, w, h)
 
-Load an image from I<data> using I<len> bytes. Returns the loaded image.
+Load an image from I<data> using I<len> bytes. Returns the loaded image. If I<w> and I<h> are given the
+image is resized to fit, keeping the aspect ratio, unless it already has the width or the height.
+
+Decoded images are cached and shared by all callers loading the same data at the same size, so they
+must not be drawn on.
+
+=head2 loadImageScaled(path, w, h)
+
+Load an image from I<path> at a reduced size, as small as possible while still at least I<w> by I<h>.
+JPEGs are scaled by 1/2, 1/4 or 1/8 while decoding and PNGs are reduced a row at a time, so large
+photos never need their full size in memory. The caller resizes the image to the exact size it needs.
+
+=head2 loadImageDataScaled(data, len, w, h)
+
+Load an image from I<data> using I<len> bytes at a reduced size, as I<loadImageScaled>. These images
+are not cached.
+
+=head2 setCacheBudget(bytes)
+
+Sets the memory budget for the decoded image cache. Unused images are dropped, oldest first, when over budget.
+
+=head2 getCacheStats()
+
+Returns a table with the decoded image cache I<entries>, I<bytes>, I<budget>, I<hits>, I<misses> and I<evictions>.
+
+=head2 acquire(w, h, alpha)
+
+As newRGB, or newRGBA if I<alpha> is true, but reusing an idle surface of the same size from the surface pool.
+The surface is cleared, and goes back to the pool when it is released or garbage collected. Use for large
+temporary surfaces, such as transition buffers.
+
+=head2 setPoolBudget(bytes)
+
+Sets the memory budget for idle surfaces in the pool. The oldest are freed when over budget.
+
+=head2 getPoolStats()
+
+Returns a table with the surface pool I<bytes>, I<budget>, I<acquires>, I<hits>, I<returns> and I<evictions>.
 
 =head2 drawText(font, color, str)
 
@@ -74,6 +111,7 @@ Returns I<w, h>, the surface size.
 Free the wrapped surface object. This can be useful if temporary surfaces are created frequently (such as when using rotozoom), Lua has
   garbage collection that will eventually free it, but since Lua does not realize the size of the data, it make the gc of it a low priority.
   This can lead to an OOM error, so it prudent to use release when working with any temporary surface. 
+A surface from acquire is returned to the surface pool.
 
 =back
 
@@ -87,6 +125,16 @@ The following methods are from the SDL_gfx package. See L<http://www.ferzkopp.ne
 
 =head2 zoom(zoomx, zoomy, smooth)
 
+=head2 rotozoomCached(angle, zoom, smooth)
+
+As rotozoom, but the result is kept and returned again for the same I<angle> and I<zoom>, to the nearest
+1/4 degree and 1/1024. Use for sprites drawn every frame, such as clock hands. The surface returned must
+not be drawn on.
+
+=head2 zoomCached(zoomx, zoomy, smooth)
+
+As zoom, kept in the same way as rotozoomCached.
+
 =head2 shrink(factorx, factory)
 
 =head2 pixel(x, y, color)
@@ -34,7 +34,8 @@ Create a tile with a single image, this is repeated to fill the area if required
 
 =head2 jive.ui.Tile:loadImageData(data, len)
 
-Create a tile using image from I<data> using I<len> bytes. Returns the tile.
+Create a tile using image from I<data> using I<len> bytes. Returns the tile. The decoded image is shared
+with surfaces loaded from the same data, see L<jive.ui.Surface>.
 
 =head2 jive.ui.Tile:loadTiles({ p1, p2, p3, p4, p5, ... })
 
@@ -1578,7 +1578,7 @@ function _transitionFadeIn(oldWindow, newWindow, duration)
 	local bgImage = Framework:getBackground()
 
 	local sw, sh = Framework:getScreenSize()
-	local srf = Surface:newRGB(sw, sh)
+	local srf = Surface:acquire(sw, sh)
 
 	-- assume old window is not updating
 	bgImage:blit(srf, 0, 0, sw, sh)
@@ -1603,6 +1603,8 @@ function _transitionFadeIn(oldWindow, newWindow, duration)
 
 			if remaining <= 0 then
 				Framework:_killTransition()
+				-- back to the surface pool for the next transition
+				srf:release()
 			end
 			animationCount = animationCount + 1
 		end
@@ -129,6 +129,53 @@ function readStringsFile(self, fullPath, stringsTable)
 	return stringsTable
 end
 
+
+--[[
+
+=head2 readStringsTable(self, fullPath, strings, stringsTable)
+
+As readStringsFile, but using I<strings> (token to translation for the
+current locale) already parsed from I<fullPath>, for example from the
+startup bundle. The file is still parsed if the locale is changed.
+
+=cut
+--]]
+
+-- meta table for pre-parsed strings
+local stringmt = {
+	__tostring = function(e)
+			     return e.str
+		     end,
+}
+
+function readStringsTable(self, fullPath, strings, stringsTable)
+	stringsTable = stringsTable or {}
+	loadedFiles[fullPath] = stringsTable
+	setmetatable(stringsTable, { __index = globalStrings })
+
+	for token, translation in pairs(strings) do
+		stringsTable[token] = setmetatable({ str = translation }, stringmt)
+	end
+
+	return stringsTable
+end
+
+
+--[[
+
+=head2 addLocales(self, locales)
+
+Add the array I<locales> to the locales returned by getAllLocales().
+
+=cut
+--]]
+function addLocales(self, locales)
+	for i, locale in ipairs(locales) do
+		allLocales[locale] = true
+	end
+end
+
+
 function _parseStringsFile(self, myLocale, myFilePath, stringsTable)
 	log:debug("parsing ", myFilePath)
 
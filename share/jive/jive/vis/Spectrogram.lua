@@ -0,0 +1,22 @@
+local oo            = require("loop.simple")
+
+local Widget        = require("jive.ui.Widget")
+
+local vis           = require("jive.vis")
+
+local FRAME_RATE    = jive.ui.FRAME_RATE
+
+
+-- _skin, _layout, _animate and draw are C functions, registered with
+-- jive.vis. The peer scrolls the spectrum as a scrolling colour map.
+module(...)
+oo.class(_M, Widget)
+
+
+function __init(self, style)
+	local obj = oo.rawnew(self, Widget(style))
+
+	obj:addAnimation(_animate, FRAME_RATE)
+
+	return obj
+end
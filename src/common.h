@@ -89,8 +89,18 @@ static inline u32_t jive_jiffies(void)
 	clock_gettime(CLOCK_MONOTONIC, &now);
 	return (now.tv_sec*1000)+(now.tv_nsec/1000000);
 }
+
+/* microsecond clock, wraps every ~71 minutes so only use for intervals */
+static inline u32_t jive_usecs(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec*1000000)+(now.tv_nsec/1000);
+}
 #else
 #define jive_jiffies() SDL_GetTicks()
+#define jive_usecs() (SDL_GetTicks()*1000)
 #endif
 
 
@@ -24,6 +24,7 @@ extern int luaopen_jive(lua_State *L);
 extern int luaopen_jive_ui_framework(lua_State *L);
 extern int luaopen_jive_net_dns(lua_State *L);
 extern int luaopen_jive_debug(lua_State *L);
+extern int luaopen_jive_bundle(lua_State *L);
 #if !defined(WIN32)
 extern int luaopen_visualizer(lua_State *L);
 #endif
@@ -93,6 +94,9 @@ static void jive_openlibs(lua_State *L) {
 	lua_pushcfunction(L, luaopen_jive_debug);
 	lua_call(L, 0, 0);
 
+	lua_pushcfunction(L, luaopen_jive_bundle);
+	lua_call(L, 0, 0);
+
 	lua_pushcfunction(L, luaopen_jive_system);
 	lua_call(L, 0, 0);
 
@@ -223,6 +223,9 @@ struct jive_widget {
 	Uint8 layer;
 	Sint16 z_order;
 	bool hidden;
+
+	/* part of the bounds drawn with opaque pixels, if known */
+	void (*opaque)(JiveWidget *peer, SDL_Rect *r);
 };
 
 struct jive_scroll_event {
@@ -318,6 +321,23 @@ struct jive_perfwarn {
 	Uint32 garbage;
 };
 
+/* frame telemetry, times are in microseconds */
+struct jive_frame_stats {
+	Uint32 ticks;		/* frame start, jive_jiffies() */
+	Uint32 layout;
+	Uint32 animate;
+	Uint32 background;
+	Uint32 draw;
+	Uint32 flip;
+	Uint32 gc;
+	Uint32 dirty;		/* pixels in the redrawn region */
+	Uint32 pixels;		/* pixels presented to the display */
+	Uint16 events;		/* ui events processed */
+	Uint16 tasks;		/* tasks resumed */
+};
+
+extern struct jive_frame_stats jive_frame;
+
 
 /* logging */
 extern LOG_CATEGORY *log_ui_draw;
@@ -353,8 +373,10 @@ void *jive_getpeer(lua_State *L, int index, JivePeerMeta *peerMeta);
 void jive_torect(lua_State *L, int index, SDL_Rect *rect);
 void jive_rect_union(SDL_Rect *a, SDL_Rect *b, SDL_Rect *c);
 void jive_rect_intersection(SDL_Rect *a, SDL_Rect *b, SDL_Rect *c);
+bool jive_rect_contains(SDL_Rect *a, SDL_Rect *b);
 void jive_queue_event(JiveEvent *evt);
 int jive_traceback (lua_State *L);
+void jive_telemetry_commit(Uint16 tasks);
 
 /* Surface functions */
 JiveSurface *jive_surface_set_video_mode(Uint16 w, Uint16 h, Uint16 bpp, bool fullscreen);
@@ -362,8 +384,17 @@ JiveSurface *jive_surface_newRGB(Uint16 w, Uint16 h);
 JiveSurface *jive_surface_newRGBA(Uint16 w, Uint16 h);
 JiveSurface *jive_surface_new_SDLSurface(SDL_Surface *sdl_surface);
 JiveSurface *jive_surface_ref(JiveSurface *srf);
+bool jive_surface_is_opaque(JiveSurface *srf);
 JiveSurface *jive_surface_load_image(const char *path);
 JiveSurface *jive_surface_load_image_data(const char *data, size_t len);
+JiveSurface *jive_surface_load_image_data_sized(const char *data, size_t len, Uint16 w, Uint16 h);
+JiveSurface *jive_surface_load_image_scaled(const char *path, Uint16 w, Uint16 h);
+JiveSurface *jive_surface_load_image_data_scaled(const char *data, size_t len, Uint16 w, Uint16 h);
+void jive_surface_set_cache_budget(size_t bytes);
+void jive_surface_get_cache_stats(size_t *bytes, size_t *budget, Uint32 *entries, Uint32 *hits, Uint32 *misses, Uint32 *evictions);
+JiveSurface *jive_surface_acquire(Uint16 w, Uint16 h, bool alpha);
+void jive_surface_set_pool_budget(size_t bytes);
+void jive_surface_get_pool_stats(size_t *bytes, size_t *budget, Uint32 *acquires, Uint32 *hits, Uint32 *returns, Uint32 *evictions);
 int jive_surface_set_wm_icon(JiveSurface *srf);
 int jive_surface_save_bmp(JiveSurface *srf, const char *file);
 int jive_surface_cmp(JiveSurface *a, JiveSurface *b, Uint32 key);
@@ -387,6 +418,7 @@ void jive_surface_release(JiveSurface *srf);
 /* Encapsulated SDL_gfx functions */
 JiveSurface *jive_surface_rotozoomSurface(JiveSurface *srf, double angle, double zoom, int smooth);
 JiveSurface *jive_surface_zoomSurface(JiveSurface *srf, double zoomx, double zoomy, int smooth);
+JiveSurface *jive_surface_rotozoom_cached(JiveSurface *srf, double angle, double zoomx, double zoomy, int smooth);
 JiveSurface *jive_surface_shrinkSurface(JiveSurface *srf, int factorx, int factory);
 JiveSurface *jive_surface_resize(JiveSurface *srf, int w, int h, bool keep_aspect);
 void jive_surface_pixelColor(JiveSurface *srf, Sint16 x, Sint16 y, Uint32 col);
@@ -417,6 +449,7 @@ JiveTile *jive_tile_load_vtiles(char *path[3]);
 JiveTile *jive_tile_load_htiles(char *path[3]);
 JiveTile *jive_tile_ref(JiveTile *tile);
 void jive_tile_get_min_size(JiveTile *tile, Uint16 *w, Uint16 *h);
+bool jive_tile_is_opaque(JiveTile *tile);
 void jive_tile_set_alpha(JiveTile *tile, Uint32 flags);
 void jive_tile_free(JiveTile *tile);
 void jive_tile_blit(JiveTile *tile, JiveSurface *dst, Uint16 dx, Uint16 dy, Uint16 dw, Uint16 dh);
@@ -437,6 +470,7 @@ int jive_font_capheight(JiveFont *font);
 int jive_font_ascend(JiveFont *font);
 int jive_font_offset(JiveFont *font);
 JiveSurface *jive_font_draw_text(JiveFont *font, Uint32 color, const char *str);
+JiveSurface *jive_font_draw_text_shadow(JiveFont *font, Uint32 fg, Uint32 sh, const char *str);
 JiveSurface *jive_font_ndraw_text(JiveFont *font, Uint32 color, const char *str, size_t len);
 Uint32 utf8_get_char(const char *ptr, const char **nptr);
 
@@ -446,6 +480,7 @@ void jive_redraw(SDL_Rect *r);
 void jive_pushevent(lua_State *L, JiveEvent *event);
 
 void jive_widget_pack(lua_State *L, int index, JiveWidget *data);
+void jive_widget_opaque_tile(JiveWidget *peer, JiveTile *tile, SDL_Rect *r);
 int jive_widget_halign(JiveWidget *this, JiveAlign align, Uint16 width);
 int jive_widget_valign(JiveWidget *this, JiveAlign align, Uint16 height);
 
@@ -467,6 +502,11 @@ int jiveL_get_background(lua_State *L);
 int jiveL_set_background(lua_State *L);
 int jiveL_dispatch_event(lua_State *L);
 int jiveL_dirty(lua_State *L);
+int jiveL_gc_step(lua_State *L);
+int jiveL_commit_frame_stats(lua_State *L);
+int jiveL_get_frame_stats(lua_State *L);
+int jiveL_reset_frame_stats(lua_State *L);
+int jiveL_dump_frame_stats(lua_State *L);
 
 int jiveL_event_new(lua_State *L);
 int jiveL_event_tostring(lua_State* L);
@@ -545,6 +585,7 @@ int jiveL_window_check_layout(lua_State *L);
 int jiveL_window_iterate(lua_State *L);
 int jiveL_window_draw_or_transition(lua_State *L);
 int jiveL_window_draw(lua_State *L);
+bool jive_window_is_opaque(lua_State *L, int index, JiveSurface *srf);
 int jiveL_window_event_handler(lua_State *L);
 int jiveL_window_gc(lua_State *L);
 
@@ -575,6 +616,13 @@ int jiveL_surface_newRGB(lua_State *L);
 int jiveL_surface_newRGBA(lua_State *L);
 int jiveL_surface_load_image(lua_State *L);
 int jiveL_surface_load_image_data(lua_State *L);
+int jiveL_surface_load_image_scaled(lua_State *L);
+int jiveL_surface_load_image_data_scaled(lua_State *L);
+int jiveL_surface_set_cache_budget(lua_State *L);
+int jiveL_surface_get_cache_stats(lua_State *L);
+int jiveL_surface_acquire(lua_State *L);
+int jiveL_surface_set_pool_budget(lua_State *L);
+int jiveL_surface_get_pool_stats(lua_State *L);
 int jiveL_surface_draw_text(lua_State *L);
 int jiveL_surface_free(lua_State *L);
 int jiveL_surface_release(lua_State *L);
@@ -590,6 +638,8 @@ int jiveL_surface_get_size(lua_State *L);
 int jiveL_surface_get_bytes(lua_State *L);
 int jiveL_surface_rotozoomSurface(lua_State *L);
 int jiveL_surface_zoomSurface(lua_State *L);
+int jiveL_surface_rotozoom_cached(lua_State *L);
+int jiveL_surface_zoom_cached(lua_State *L);
 int jiveL_surface_shrinkSurface(lua_State *L);
 int jiveL_surface_resize(lua_State *L);
 int jiveL_surface_pixelColor(lua_State *L);
@@ -628,4 +678,8 @@ int jiveL_surfacetile_gc(lua_State *L);
 
 void copyResampled (SDL_Surface *dst, SDL_Surface *src, int dstX, int dstY, int srcX, int srcY,	int dstW, int dstH, int srcW, int srcH);
 
+SDL_Surface *jive_image_decode_scaled(const char *data, size_t len, Uint16 w, Uint16 h);
+
+int jive_blend_blit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect);
+
 #endif // JIVE_H
@@ -0,0 +1,297 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "common.h"
+#include "jive.h"
+
+/*
+ * Blitting for the common 32 bit cases, alpha images and text onto the
+ * screen or an RGB surface, and constant alpha fades. SDL 1.2 blends
+ * these a pixel at a time, and has no vector code at all on ARM. Here
+ * four (SSE2) or eight (NEON) pixels are blended at once, and runs of
+ * fully transparent or fully opaque pixels are skipped or copied.
+ *
+ * Pixels keep straight alpha, so surfaces can still be rotozoomed, read
+ * and saved as before, and the result matches SDL_BlitSurface to within
+ * rounding. Anything else, such as 16 bit screens, colour keys, RLE
+ * surfaces and alpha destinations, is left to SDL_BlitSurface.
+ */
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLEND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define BLEND_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#define AMASK 0xFF000000
+
+
+/* s over d with alpha a, rounded exactly */
+static inline Uint32 _blend(Uint32 s, Uint32 d, Uint32 a) {
+	Uint32 rb, ag;
+
+	rb = (s & 0x00FF00FF) * a + (d & 0x00FF00FF) * (255 - a) + 0x00800080;
+	rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+	ag = ((s >> 8) & 0x00FF00FF) * a + ((d >> 8) & 0x00FF00FF) * (255 - a) + 0x00800080;
+	ag = (ag + ((ag >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+
+	return rb | ag;
+}
+
+
+/* per pixel alpha */
+static void _over_row(Uint32 *d, const Uint32 *s, int n) {
+	int i = 0;
+
+#if defined(BLEND_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i amask = _mm_set1_epi32(AMASK);
+	const __m128i one = _mm_set1_epi16(255);
+	const __m128i round = _mm_set1_epi16(128);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i sv = _mm_loadu_si128((const __m128i *) (s + i));
+		__m128i av = _mm_and_si128(sv, amask);
+		__m128i dv, slo, shi, dlo, dhi, alo, ahi;
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(av, zero)) == 0xFFFF) {
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(av, amask)) == 0xFFFF) {
+			_mm_storeu_si128((__m128i *) (d + i), sv);
+			continue;
+		}
+
+		dv = _mm_loadu_si128((const __m128i *) (d + i));
+
+		slo = _mm_unpacklo_epi8(sv, zero);
+		shi = _mm_unpackhi_epi8(sv, zero);
+		dlo = _mm_unpacklo_epi8(dv, zero);
+		dhi = _mm_unpackhi_epi8(dv, zero);
+
+		/* alpha is the top byte of each pixel */
+		alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		slo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(slo, alo), _mm_mullo_epi16(dlo, _mm_sub_epi16(one, alo))), round);
+		shi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(shi, ahi), _mm_mullo_epi16(dhi, _mm_sub_epi16(one, ahi))), round);
+		slo = _mm_srli_epi16(_mm_add_epi16(slo, _mm_srli_epi16(slo, 8)), 8);
+		shi = _mm_srli_epi16(_mm_add_epi16(shi, _mm_srli_epi16(shi, 8)), 8);
+
+		_mm_storeu_si128((__m128i *) (d + i), _mm_packus_epi16(slo, shi));
+	}
+#elif defined(BLEND_NEON)
+	for (; i + 8 <= n; i += 8) {
+		uint8x8x4_t sv = vld4_u8((const uint8_t *) (s + i));
+		uint8x8x4_t dv;
+		uint8x8_t ia;
+		Uint64 a = vget_lane_u64(vreinterpret_u64_u8(sv.val[3]), 0);
+		int c;
+
+		if (a == 0) {
+			continue;
+		}
+		if (a == 0xFFFFFFFFFFFFFFFFULL) {
+			memcpy(d + i, s + i, 8 * sizeof(Uint32));
+			continue;
+		}
+
+		dv = vld4_u8((const uint8_t *) (d + i));
+		ia = vmvn_u8(sv.val[3]);
+
+		for (c = 0; c < 4; c++) {
+			uint16x8_t t = vmlal_u8(vmull_u8(sv.val[c], sv.val[3]), dv.val[c], ia);
+			dv.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+		}
+
+		vst4_u8((uint8_t *) (d + i), dv);
+	}
+#endif
+
+	for (; i < n; i++) {
+		Uint32 a = s[i] >> 24;
+
+		if (a == 255) {
+			d[i] = s[i];
+		}
+		else if (a) {
+			d[i] = _blend(s[i], d[i], a);
+		}
+	}
+}
+
+
+/* surface alpha, for sources without an alpha channel */
+static void _fade_row(Uint32 *d, const Uint32 *s, int n, Uint8 alpha) {
+	int i = 0;
+
+#if defined(BLEND_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i av = _mm_set1_epi16(alpha);
+	const __m128i iav = _mm_set1_epi16(255 - alpha);
+	const __m128i round = _mm_set1_epi16(128);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i sv = _mm_loadu_si128((const __m128i *) (s + i));
+		__m128i dv = _mm_loadu_si128((const __m128i *) (d + i));
+		__m128i lo, hi;
+
+		lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(sv, zero), av), _mm_mullo_epi16(_mm_unpacklo_epi8(dv, zero), iav)), round);
+		hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(sv, zero), av), _mm_mullo_epi16(_mm_unpackhi_epi8(dv, zero), iav)), round);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+		_mm_storeu_si128((__m128i *) (d + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(BLEND_NEON)
+	const uint8x16_t av = vdupq_n_u8(alpha);
+	const uint8x16_t iav = vdupq_n_u8(255 - alpha);
+
+	for (; i + 4 <= n; i += 4) {
+		uint8x16_t sv = vld1q_u8((const uint8_t *) (s + i));
+		uint8x16_t dv = vld1q_u8((const uint8_t *) (d + i));
+		uint16x8_t lo, hi;
+
+		lo = vmlal_u8(vmull_u8(vget_low_u8(sv), vget_low_u8(av)), vget_low_u8(dv), vget_low_u8(iav));
+		hi = vmlal_u8(vmull_u8(vget_high_u8(sv), vget_high_u8(av)), vget_high_u8(dv), vget_high_u8(iav));
+
+		vst1q_u8((uint8_t *) (d + i), vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8))));
+	}
+#endif
+
+	for (; i < n; i++) {
+		d[i] = _blend(s[i], d[i], alpha);
+	}
+}
+
+
+/*
+ * Drop in replacement for SDL_BlitSurface(), with the same clipping.
+ */
+int jive_blend_blit(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect) {
+	SDL_PixelFormat *sf, *df;
+	SDL_Rect *clip;
+	int sx, sy, dx, dy, w, h, y;
+	enum { COPY, OVER, FADE } mode;
+	Uint8 alpha = SDL_ALPHA_OPAQUE;
+
+	if (!src || !dst || src == dst) {
+		return SDL_BlitSurface(src, srcrect, dst, dstrect);
+	}
+
+	sf = src->format;
+	df = dst->format;
+
+	if (sf->BytesPerPixel != 4 || df->BytesPerPixel != 4
+	    || sf->Rmask != df->Rmask || sf->Gmask != df->Gmask || sf->Bmask != df->Bmask
+	    || df->Amask || (sf->Amask && sf->Amask != AMASK)
+	    || (src->flags & (SDL_SRCCOLORKEY | SDL_RLEACCEL)) || SDL_MUSTLOCK(src)) {
+		return SDL_BlitSurface(src, srcrect, dst, dstrect);
+	}
+
+	/* as SDL, the surface alpha is ignored when there is an alpha channel */
+	if (!(src->flags & SDL_SRCALPHA)) {
+		mode = COPY;
+	}
+	else if (sf->Amask) {
+		mode = OVER;
+	}
+	else if (sf->alpha == SDL_ALPHA_OPAQUE) {
+		mode = COPY;
+	}
+	else {
+		mode = FADE;
+		alpha = sf->alpha;
+	}
+
+	/* clip as SDL_UpperBlit */
+	if (srcrect) {
+		sx = srcrect->x;
+		sy = srcrect->y;
+		w = srcrect->w;
+		h = srcrect->h;
+
+		if (sx < 0) {
+			w += sx;
+			sx = 0;
+		}
+		if (sy < 0) {
+			h += sy;
+			sy = 0;
+		}
+		w = MIN(w, src->w - sx);
+		h = MIN(h, src->h - sy);
+
+		dx = (dstrect ? dstrect->x : 0) + (sx - srcrect->x);
+		dy = (dstrect ? dstrect->y : 0) + (sy - srcrect->y);
+	}
+	else {
+		sx = sy = 0;
+		w = src->w;
+		h = src->h;
+
+		dx = dstrect ? dstrect->x : 0;
+		dy = dstrect ? dstrect->y : 0;
+	}
+
+	clip = &dst->clip_rect;
+
+	if (dx < clip->x) {
+		sx += clip->x - dx;
+		w -= clip->x - dx;
+		dx = clip->x;
+	}
+	if (dy < clip->y) {
+		sy += clip->y - dy;
+		h -= clip->y - dy;
+		dy = clip->y;
+	}
+	w = MIN(w, clip->x + clip->w - dx);
+	h = MIN(h, clip->y + clip->h - dy);
+
+	if (dstrect) {
+		dstrect->x = dx;
+		dstrect->y = dy;
+		dstrect->w = MAX(w, 0);
+		dstrect->h = MAX(h, 0);
+	}
+
+	if (w <= 0 || h <= 0 || (mode == FADE && alpha == SDL_ALPHA_TRANSPARENT)) {
+		return 0;
+	}
+
+	if (SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) < 0) {
+		return -1;
+	}
+
+	for (y = 0; y < h; y++) {
+		Uint32 *s = (Uint32 *) ((Uint8 *) src->pixels + (sy + y) * src->pitch) + sx;
+		Uint32 *d = (Uint32 *) ((Uint8 *) dst->pixels + (dy + y) * dst->pitch) + dx;
+
+		switch (mode) {
+		case COPY:
+			memcpy(d, s, w * sizeof(Uint32));
+			break;
+		case OVER:
+			_over_row(d, s, w);
+			break;
+		case FADE:
+			_fade_row(d, s, w, alpha);
+			break;
+		}
+	}
+
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_UnlockSurface(dst);
+	}
+
+	return 0;
+}
@@ -0,0 +1,470 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "common.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+/*
+ * Startup bundle. A single indexed file of named chunks (precompiled
+ * bytecode or plain data) used by the AppletManager to avoid scanning
+ * and parsing the applet tree at boot. The file is mapped read only,
+ * chunks are loaded straight from the mapping.
+ *
+ * The layout is a header (magic, version, entry count, fingerprint
+ * length as native endian Uint32), the fingerprint, the index entries
+ * (name length, data offset, data length, then the name), followed by
+ * the chunk data. Offsets are from the start of the file.
+ */
+
+#define BUNDLE_MAGIC "JVBN"
+#define BUNDLE_VERSION 1
+
+
+struct bundle_entry {
+	const char *name;
+	Uint32 name_len;
+	Uint32 offset;
+	Uint32 len;
+};
+
+struct bundle {
+	const char *data;
+	size_t size;
+	bool mapped;
+
+	const char *fingerprint;
+	Uint32 fingerprint_len;
+
+	Uint32 count;
+	struct bundle_entry *entries;
+};
+
+
+static void bundle_free(struct bundle *b) {
+	if (b->entries) {
+		free(b->entries);
+		b->entries = NULL;
+	}
+
+	if (b->data) {
+#ifndef WIN32
+		if (b->mapped) {
+			munmap((void *)b->data, b->size);
+		}
+		else
+#endif
+		{
+			free((void *)b->data);
+		}
+		b->data = NULL;
+	}
+}
+
+
+static bool bundle_map(struct bundle *b, const char *path) {
+#ifndef WIN32
+	struct stat st;
+	void *data;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	b->data = data;
+	b->size = st.st_size;
+	b->mapped = true;
+
+	return true;
+#else
+	FILE *fp;
+	long size;
+	char *data;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if (size <= 0 || !(data = malloc(size))) {
+		fclose(fp);
+		return false;
+	}
+
+	if (fread(data, size, 1, fp) != 1) {
+		free(data);
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+
+	b->data = data;
+	b->size = size;
+	b->mapped = false;
+
+	return true;
+#endif
+}
+
+
+static Uint32 bundle_u32(struct bundle *b, size_t *pos, bool *ok) {
+	Uint32 v;
+
+	if (*pos + sizeof(Uint32) > b->size) {
+		*ok = false;
+		return 0;
+	}
+
+	memcpy(&v, b->data + *pos, sizeof(Uint32));
+	*pos += sizeof(Uint32);
+
+	return v;
+}
+
+
+static bool bundle_parse(struct bundle *b) {
+	size_t pos = 4;
+	bool ok = true;
+	Uint32 i;
+
+	if (b->size < 4 || memcmp(b->data, BUNDLE_MAGIC, 4) != 0) {
+		return false;
+	}
+
+	if (bundle_u32(b, &pos, &ok) != BUNDLE_VERSION) {
+		return false;
+	}
+
+	b->count = bundle_u32(b, &pos, &ok);
+	b->fingerprint_len = bundle_u32(b, &pos, &ok);
+	if (!ok || pos + b->fingerprint_len > b->size) {
+		return false;
+	}
+
+	b->fingerprint = b->data + pos;
+	pos += b->fingerprint_len;
+
+	b->entries = calloc(b->count, sizeof(struct bundle_entry));
+	if (b->count && !b->entries) {
+		return false;
+	}
+
+	for (i = 0; i < b->count; i++) {
+		struct bundle_entry *e = &b->entries[i];
+
+		e->name_len = bundle_u32(b, &pos, &ok);
+		e->offset = bundle_u32(b, &pos, &ok);
+		e->len = bundle_u32(b, &pos, &ok);
+		if (!ok || pos + e->name_len > b->size || (size_t)e->offset + e->len > b->size) {
+			return false;
+		}
+
+		e->name = b->data + pos;
+		pos += e->name_len;
+	}
+
+	return true;
+}
+
+
+static struct bundle_entry *bundle_find(struct bundle *b, const char *name, size_t len) {
+	Uint32 i;
+
+	for (i = 0; i < b->count; i++) {
+		struct bundle_entry *e = &b->entries[i];
+
+		if (e->name_len == len && memcmp(e->name, name, len) == 0) {
+			return e;
+		}
+	}
+
+	return NULL;
+}
+
+
+static struct bundle *bundle_check(lua_State *L) {
+	struct bundle *b = luaL_checkudata(L, 1, "jive.bundle");
+
+	if (!b->data) {
+		luaL_error(L, "bundle is closed");
+	}
+
+	return b;
+}
+
+
+static int jiveL_bundle_open(lua_State *L) {
+	const char *path;
+	struct bundle *b;
+
+	/* stack is:
+	 * 1: path
+	 */
+
+	path = luaL_checkstring(L, 1);
+
+	b = lua_newuserdata(L, sizeof(struct bundle));
+	memset(b, 0, sizeof(struct bundle));
+
+	luaL_getmetatable(L, "jive.bundle");
+	lua_setmetatable(L, -2);
+
+	if (!bundle_map(b, path)) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", path, strerror(errno));
+		return 2;
+	}
+
+	if (!bundle_parse(b)) {
+		bundle_free(b);
+
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: invalid bundle", path);
+		return 2;
+	}
+
+	return 1;
+}
+
+
+static int jiveL_bundle_gc(lua_State *L) {
+	struct bundle *b = lua_touserdata(L, 1);
+
+	bundle_free(b);
+
+	return 0;
+}
+
+
+static int jiveL_bundle_fingerprint(lua_State *L) {
+	struct bundle *b = bundle_check(L);
+
+	lua_pushlstring(L, b->fingerprint, b->fingerprint_len);
+	return 1;
+}
+
+
+static int jiveL_bundle_read(lua_State *L) {
+	struct bundle *b = bundle_check(L);
+	struct bundle_entry *e;
+	const char *name;
+	size_t len;
+
+	/* stack is:
+	 * 1: bundle
+	 * 2: name
+	 */
+
+	name = luaL_checklstring(L, 2, &len);
+
+	e = bundle_find(b, name, len);
+	if (!e) {
+		return 0;
+	}
+
+	lua_pushlstring(L, b->data + e->offset, e->len);
+	return 1;
+}
+
+
+static int jiveL_bundle_load(lua_State *L) {
+	struct bundle *b = bundle_check(L);
+	struct bundle_entry *e;
+	const char *name;
+	size_t len;
+
+	/* stack is:
+	 * 1: bundle
+	 * 2: name
+	 * 3: chunk name (optional)
+	 */
+
+	name = luaL_checklstring(L, 2, &len);
+
+	e = bundle_find(b, name, len);
+	if (!e) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s not in bundle", name);
+		return 2;
+	}
+
+	if (luaL_loadbuffer(L, b->data + e->offset, e->len, luaL_optstring(L, 3, name)) != 0) {
+		lua_pushnil(L);
+		lua_insert(L, -2);
+		return 2;
+	}
+
+	return 1;
+}
+
+
+static int jiveL_bundle_close(lua_State *L) {
+	struct bundle *b = luaL_checkudata(L, 1, "jive.bundle");
+
+	bundle_free(b);
+
+	return 0;
+}
+
+
+static int jiveL_bundle_write(lua_State *L) {
+	const char *path, *fingerprint;
+	size_t fingerprint_len;
+	char *tmppath;
+	Uint32 header[3], count, offset, i;
+	FILE *fp;
+	bool ok = true;
+
+	/* stack is:
+	 * 1: path
+	 * 2: fingerprint
+	 * 3: array of { name, data }
+	 */
+
+	path = luaL_checkstring(L, 1);
+	fingerprint = luaL_checklstring(L, 2, &fingerprint_len);
+	luaL_checktype(L, 3, LUA_TTABLE);
+
+	count = lua_objlen(L, 3);
+
+	/* write to a temporary file, so a mapped bundle is never truncated */
+	lua_pushfstring(L, "%s.tmp", path);
+	tmppath = (char *)lua_tostring(L, -1);
+
+	fp = fopen(tmppath, "wb");
+	if (!fp) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", tmppath, strerror(errno));
+		return 2;
+	}
+
+	header[0] = BUNDLE_VERSION;
+	header[1] = count;
+	header[2] = fingerprint_len;
+
+	ok &= fwrite(BUNDLE_MAGIC, 4, 1, fp) == 1;
+	ok &= fwrite(header, sizeof(header), 1, fp) == 1;
+	ok &= fwrite(fingerprint, fingerprint_len, 1, fp) == 1 || fingerprint_len == 0;
+
+	/* index, data follows the index */
+	offset = 4 + sizeof(header) + fingerprint_len;
+	for (i = 1; i <= count; i++) {
+		lua_rawgeti(L, 3, i);
+		lua_rawgeti(L, -1, 1);
+		offset += 3 * sizeof(Uint32) + lua_objlen(L, -1);
+		lua_pop(L, 2);
+	}
+
+	for (i = 1; i <= count; i++) {
+		const char *name;
+		size_t name_len, len;
+		Uint32 entry[3];
+
+		lua_rawgeti(L, 3, i);
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+		name = luaL_checklstring(L, -2, &name_len);
+		luaL_checklstring(L, -1, &len);
+
+		entry[0] = name_len;
+		entry[1] = offset;
+		entry[2] = len;
+		offset += len;
+
+		ok &= fwrite(entry, sizeof(entry), 1, fp) == 1;
+		ok &= fwrite(name, name_len, 1, fp) == 1;
+
+		lua_pop(L, 3);
+	}
+
+	for (i = 1; i <= count; i++) {
+		const char *data;
+		size_t len;
+
+		lua_rawgeti(L, 3, i);
+		lua_rawgeti(L, -1, 2);
+		data = lua_tolstring(L, -1, &len);
+
+		if (len) {
+			ok &= fwrite(data, len, 1, fp) == 1;
+		}
+
+		lua_pop(L, 2);
+	}
+
+	if (fclose(fp) != 0 || !ok) {
+		remove(tmppath);
+
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: write failed", tmppath);
+		return 2;
+	}
+
+#ifdef WIN32
+	remove(path);
+#endif
+	if (rename(tmppath, path) != 0) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", path, strerror(errno));
+		return 2;
+	}
+
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+
+static const struct luaL_Reg bundle_m[] = {
+	{ "__gc", jiveL_bundle_gc },
+	{ "fingerprint", jiveL_bundle_fingerprint },
+	{ "read", jiveL_bundle_read },
+	{ "load", jiveL_bundle_load },
+	{ "close", jiveL_bundle_close },
+	{ NULL, NULL }
+};
+
+
+static const struct luaL_Reg bundle_f[] = {
+	{ "open", jiveL_bundle_open },
+	{ "write", jiveL_bundle_write },
+	{ NULL, NULL }
+};
+
+
+int luaopen_jive_bundle(lua_State *L) {
+	luaL_newmetatable(L, "jive.bundle");
+
+	lua_pushvalue(L, -1);
+	lua_setfield(L, -2, "__index");
+
+	luaL_register(L, NULL, bundle_m);
+
+	luaL_register(L, "jive.bundle", bundle_f);
+
+	return 0;
+}
@@ -105,6 +105,284 @@ static int jiveL_perfhook(lua_State *L) {
 }
 
 
+/*
+ * Sampling profiler. A SIGPROF interval timer arms a one shot count
+ * hook, so the Lua stack is only walked when a sample is due and the
+ * interpreter runs at full speed in between. Where interval timers are
+ * not available a count hook samples every PROFILE_COUNT instructions.
+ *
+ * Samples are stored as arrays of frame ids in a buffer allocated when
+ * profiling starts, frame names are interned in a fixed size table.
+ * With LuaJIT, code inside compiled traces is attributed once it
+ * returns to the interpreter.
+ */
+
+#define PROFILE_MAX_DEPTH	32
+#define PROFILE_MAX_FRAMES	4096	/* must be a power of two */
+#define PROFILE_FRAME_NAME	96
+#define PROFILE_COUNT		10000
+#define PROFILE_MAX_HZ		1000000
+#define PROFILE_MAX_SAMPLES	1000000
+#define PROFILE_FRAME_FULL	0xFFFF	/* frame not recorded, the table is full */
+
+#if defined(ITIMER_PROF) && !defined(WIN32)
+#define PROFILE_TIMER 1
+#endif
+
+struct profile_frame {
+	Uint32 hash;
+	char name[PROFILE_FRAME_NAME];
+};
+
+struct profile_state {
+	lua_State *L;
+	bool running;
+	Uint32 max_samples;
+	Uint32 nsamples;
+	Uint32 dropped;
+	Uint32 nframes;
+	Uint16 *samples;		/* max_samples * PROFILE_MAX_DEPTH, 0 terminated */
+	struct profile_frame *frames;	/* PROFILE_MAX_FRAMES, id 0 unused */
+};
+
+static struct profile_state prof;
+
+
+static Uint16 profile_frame_id(lua_Debug *ar) {
+	char name[PROFILE_FRAME_NAME];
+	char *ptr;
+	Uint32 hash = 2166136261u;
+	Uint32 i;
+
+	if (*ar->what == 'C') {
+		snprintf(name, sizeof(name), "%s@[C]", ar->name ? ar->name : "?");
+	}
+	else {
+		snprintf(name, sizeof(name), "%s@%s:%d", ar->name ? ar->name : (*ar->what == 'm' ? "main" : "?"), ar->short_src, ar->linedefined);
+	}
+
+	/* ';' separates frames in the folded output */
+	for (ptr = name; *ptr; ptr++) {
+		if (*ptr == ';') {
+			*ptr = '_';
+		}
+		hash = (hash ^ (Uint8)*ptr) * 16777619u;
+	}
+
+	/* hash 0 marks an empty slot */
+	if (!hash) {
+		hash = 1;
+	}
+
+	/* open addressing skipping id 0, the table is never more than half full */
+	i = hash & (PROFILE_MAX_FRAMES - 1);
+	while (i == 0 || prof.frames[i].hash) {
+		if (i && prof.frames[i].hash == hash && strcmp(prof.frames[i].name, name) == 0) {
+			return i;
+		}
+		i = (i + 1) & (PROFILE_MAX_FRAMES - 1);
+	}
+
+	if (prof.nframes >= PROFILE_MAX_FRAMES / 2) {
+		return PROFILE_FRAME_FULL;
+	}
+
+	prof.frames[i].hash = hash;
+	strcpy(prof.frames[i].name, name);
+	prof.nframes++;
+
+	return i;
+}
+
+
+static void profile_hook(lua_State *L, lua_Debug *ar) {
+	lua_Debug frame;
+	Uint16 *sample;
+	int level;
+
+#ifdef PROFILE_TIMER
+	/* one shot, the timer arms the hook again */
+	lua_sethook(L, NULL, 0, 0);
+#endif
+
+	if (!prof.running) {
+		return;
+	}
+
+	if (prof.nsamples >= prof.max_samples) {
+		prof.dropped++;
+		return;
+	}
+
+	sample = prof.samples + (prof.nsamples * PROFILE_MAX_DEPTH);
+
+	for (level = 0; level < PROFILE_MAX_DEPTH - 1 && lua_getstack(L, level, &frame); level++) {
+		lua_getinfo(L, "Sn", &frame);
+		sample[level] = profile_frame_id(&frame);
+	}
+	sample[level] = 0;
+
+	if (level) {
+		prof.nsamples++;
+	}
+}
+
+
+#ifdef PROFILE_TIMER
+static void profile_signal(int sig) {
+	if (prof.running) {
+		lua_sethook(prof.L, profile_hook, LUA_MASKCOUNT, 1);
+	}
+}
+#endif
+
+
+static void profile_free(void) {
+	free(prof.samples);
+	free(prof.frames);
+	memset(&prof, 0, sizeof(prof));
+}
+
+
+/*
+ * Start the sampling profiler. Takes two optional arguments, the
+ * sample rate in Hz (default 100) and the maximum number of samples
+ * to record (default 10000). Any previous profile is discarded.
+ */
+static int jiveL_profile_start(lua_State *L) {
+	int hz = luaL_optinteger(L, 1, 100);
+	int max_samples = luaL_optinteger(L, 2, 10000);
+
+	luaL_argcheck(L, hz >= 1 && hz <= PROFILE_MAX_HZ, 1, "rate out of range");
+	luaL_argcheck(L, max_samples >= 1 && max_samples <= PROFILE_MAX_SAMPLES, 2, "samples out of range");
+
+	if (prof.running || lua_gethook(L) != NULL) {
+		lua_pushnil(L);
+		lua_pushstring(L, "debug hook already installed");
+		return 2;
+	}
+
+	profile_free();
+
+	prof.samples = malloc(max_samples * PROFILE_MAX_DEPTH * sizeof(Uint16));
+	prof.frames = calloc(PROFILE_MAX_FRAMES, sizeof(struct profile_frame));
+	if (!prof.samples || !prof.frames) {
+		profile_free();
+		return luaL_error(L, "cannot allocate profile buffer");
+	}
+
+	prof.L = L;
+	prof.max_samples = max_samples;
+	prof.running = true;
+
+#ifdef PROFILE_TIMER
+	{
+		struct itimerval timer;
+		long usecs = 1000000 / hz;
+
+		signal(SIGPROF, profile_signal);
+
+		timer.it_interval.tv_sec = usecs / 1000000;
+		timer.it_interval.tv_usec = usecs % 1000000;
+		timer.it_value = timer.it_interval;
+		setitimer(ITIMER_PROF, &timer, NULL);
+	}
+#else
+	lua_sethook(L, profile_hook, LUA_MASKCOUNT, PROFILE_COUNT);
+#endif
+
+	LOG_INFO(log_debug_hooks, "profiler started");
+
+	lua_pushboolean(L, 1);
+	return 1;
+}
+
+
+/* Stop the sampling profiler, returns the number of samples recorded */
+static int jiveL_profile_stop(lua_State *L) {
+	if (prof.running) {
+#ifdef PROFILE_TIMER
+		struct itimerval timer;
+
+		memset(&timer, 0, sizeof(timer));
+		setitimer(ITIMER_PROF, &timer, NULL);
+		signal(SIGPROF, SIG_IGN);
+#endif
+		prof.running = false;
+		lua_sethook(L, NULL, 0, 0);
+
+		LOG_INFO(log_debug_hooks, "profiler stopped: %d samples, %d dropped, %d frames", prof.nsamples, prof.dropped, prof.nframes);
+	}
+
+	lua_pushinteger(L, prof.nsamples);
+	lua_pushinteger(L, prof.dropped);
+	return 2;
+}
+
+
+/*
+ * Write the recorded samples as folded stacks (one "root;...;leaf count"
+ * line per unique stack), as used by flamegraph.pl. Returns the number
+ * of unique stacks written.
+ */
+static int jiveL_profile_dump(lua_State *L) {
+	const char *path = luaL_checkstring(L, 1);
+	FILE *fp;
+	Uint32 i;
+	int level, stacks = 0;
+
+	if (!prof.samples) {
+		lua_pushnil(L);
+		lua_pushstring(L, "no profile recorded");
+		return 2;
+	}
+
+	/* count unique stacks in a table */
+	lua_newtable(L);
+	for (i = 0; i < prof.nsamples; i++) {
+		Uint16 *sample = prof.samples + (i * PROFILE_MAX_DEPTH);
+		luaL_Buffer b;
+
+		for (level = 0; sample[level]; level++)
+			;
+
+		luaL_buffinit(L, &b);
+		while (level--) {
+			luaL_addstring(&b, sample[level] != PROFILE_FRAME_FULL ? prof.frames[sample[level]].name : "?");
+			if (level) {
+				luaL_addchar(&b, ';');
+			}
+		}
+		luaL_pushresult(&b);
+
+		lua_pushvalue(L, -1);
+		lua_rawget(L, -3);
+		lua_pushinteger(L, lua_tointeger(L, -1) + 1);
+		lua_replace(L, -2);
+		lua_rawset(L, -3);
+	}
+
+	fp = fopen(path, "w");
+	if (!fp) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", path, strerror(errno));
+		return 2;
+	}
+
+	lua_pushnil(L);
+	while (lua_next(L, -2) != 0) {
+		fprintf(fp, "%s %d\n", lua_tostring(L, -2), (int) lua_tointeger(L, -1));
+		stacks++;
+		lua_pop(L, 1);
+	}
+
+	fclose(fp);
+
+	lua_pushinteger(L, stacks);
+	return 1;
+}
+
+
 struct heap_state {
 	long number;
 	long integer;
@@ -386,9 +664,444 @@ static int jiveL_heap(lua_State *L) {
 }
 
 
+/*
+ * Incremental heap snapshot. Rather than recursing through the heap in
+ * one call, reachable objects are pushed onto an explicit work stack
+ * (held in the registry) and processed in time limited steps, so a
+ * snapshot can be spread over many frames. Objects are aggregated by
+ * type, class and owner, where the class is the _NAME of the metatable
+ * (or the registry name for userdata metatables) and the owner is the
+ * module the object was first reached from.
+ *
+ * Objects changing between steps makes the snapshot approximate, which
+ * is fine for spotting growth between two snapshots.
+ */
+
+/* registry fields of the snapshot state table */
+#define SNAPSHOT_STATE	"heap_snapshot"
+
+/* state table indexes */
+enum {
+	SNAPSHOT_SEEN = 1,	/* weak keyed set of visited objects */
+	SNAPSHOT_STACK,		/* objects waiting to be traversed */
+	SNAPSHOT_OWNERS,	/* owner names, parallel to the stack */
+	SNAPSHOT_NAMES,		/* metatable -> registry name */
+	SNAPSHOT_COUNT,		/* key -> object count */
+	SNAPSHOT_SIZE,		/* key -> approximate size */
+};
+
+static int snapshot_top;
+static int snapshot_objects;
+
+
+/* push the class name of the object at index */
+static void snapshot_class(lua_State *L, int state, int index) {
+	if (!lua_getmetatable(L, index)) {
+		lua_pushliteral(L, "-");
+		return;
+	}
+
+	lua_pushliteral(L, "_NAME");
+	lua_rawget(L, -2);
+	if (lua_isstring(L, -1)) {
+		lua_remove(L, -2);
+		return;
+	}
+	lua_pop(L, 1);
+
+	lua_rawgeti(L, state, SNAPSHOT_NAMES);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	if (lua_isstring(L, -1)) {
+		lua_replace(L, -3);
+		lua_pop(L, 1);
+		return;
+	}
+	lua_pop(L, 3);
+
+	lua_pushliteral(L, "?");
+}
+
+
+/* count the object at index, and queue it for traversal */
+static void snapshot_visit(lua_State *L, int state, int index, const char *owner) {
+	int type = lua_type(L, index);
+	size_t size = 0;
+
+	switch (type) {
+	case LUA_TSTRING:
+		size = lua_objlen(L, index);
+		break;
+	case LUA_TTABLE:
+	case LUA_TFUNCTION:
+	case LUA_TUSERDATA:
+	case LUA_TTHREAD:
+		break;
+	default:
+		return;
+	}
+
+	/* seen? */
+	lua_rawgeti(L, state, SNAPSHOT_SEEN);
+	lua_pushvalue(L, index);
+	lua_rawget(L, -2);
+	if (!lua_isnil(L, -1)) {
+		lua_pop(L, 2);
+		return;
+	}
+	lua_pop(L, 1);
+	lua_pushvalue(L, index);
+	lua_pushboolean(L, 1);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+
+	if (type != LUA_TSTRING) {
+		/* queue for traversal */
+		snapshot_top++;
+
+		lua_rawgeti(L, state, SNAPSHOT_STACK);
+		lua_pushvalue(L, index);
+		lua_rawseti(L, -2, snapshot_top);
+		lua_pop(L, 1);
+
+		lua_rawgeti(L, state, SNAPSHOT_OWNERS);
+		lua_pushstring(L, owner);
+		lua_rawseti(L, -2, snapshot_top);
+		lua_pop(L, 1);
+
+		return;
+	}
+
+	/* strings are counted now */
+	lua_pushfstring(L, "string/-/%s", owner);
+	lua_rawgeti(L, state, SNAPSHOT_COUNT);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	lua_pushvalue(L, -3);
+	lua_pushinteger(L, lua_tointeger(L, -2) + 1);
+	lua_rawset(L, -4);
+	lua_pop(L, 2);
+
+	lua_rawgeti(L, state, SNAPSHOT_SIZE);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	lua_pushvalue(L, -3);
+	lua_pushinteger(L, lua_tointeger(L, -2) + size);
+	lua_rawset(L, -4);
+	lua_pop(L, 3);
+
+	snapshot_objects++;
+}
+
+
+/* traverse the object on the top of the stack */
+static void snapshot_traverse(lua_State *L, int state, const char *owner) {
+	int index = lua_gettop(L);
+	int type = lua_type(L, index);
+	size_t size = 0;
+	int i;
+
+	switch (type) {
+	case LUA_TTABLE:
+		lua_pushnil(L);
+		while (lua_next(L, index) != 0) {
+			int top = lua_gettop(L);
+
+			snapshot_visit(L, state, top - 1, owner);
+			snapshot_visit(L, state, top, owner);
+			lua_pop(L, 1);
+			size++;
+		}
+		break;
+
+	case LUA_TFUNCTION:
+		for (i = 1; lua_getupvalue(L, index, i) != NULL; i++) {
+			snapshot_visit(L, state, lua_gettop(L), owner);
+			lua_pop(L, 1);
+			size++;
+		}
+
+		lua_getfenv(L, index);
+		snapshot_visit(L, state, lua_gettop(L), owner);
+		lua_pop(L, 1);
+		break;
+
+	case LUA_TUSERDATA:
+		size = lua_objlen(L, index);
+
+		lua_getfenv(L, index);
+		snapshot_visit(L, state, lua_gettop(L), owner);
+		lua_pop(L, 1);
+		break;
+	}
+
+	if (lua_getmetatable(L, index)) {
+		snapshot_visit(L, state, lua_gettop(L), owner);
+		lua_pop(L, 1);
+	}
+
+	/* aggregate */
+	lua_pushstring(L, lua_typename(L, type));
+	lua_pushliteral(L, "/");
+	snapshot_class(L, state, index);
+	lua_pushliteral(L, "/");
+	lua_pushstring(L, owner);
+	lua_concat(L, 5);
+
+	lua_rawgeti(L, state, SNAPSHOT_COUNT);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	lua_pushvalue(L, -3);
+	lua_pushinteger(L, lua_tointeger(L, -2) + 1);
+	lua_rawset(L, -4);
+	lua_pop(L, 2);
+
+	lua_rawgeti(L, state, SNAPSHOT_SIZE);
+	lua_pushvalue(L, -2);
+	lua_rawget(L, -2);
+	lua_pushvalue(L, -3);
+	lua_pushinteger(L, lua_tointeger(L, -2) + size);
+	lua_rawset(L, -4);
+	lua_pop(L, 3);
+
+	snapshot_objects++;
+}
+
+
+/*
+ * Start an incremental heap snapshot, discarding any snapshot in
+ * progress. Use heapSnapshotStep() to complete it.
+ */
+static int jiveL_heap_snapshot(lua_State *L) {
+	int state, i;
+
+	lua_settop(L, 0);
+
+	lua_createtable(L, 6, 0);
+	state = lua_gettop(L);
+
+	/* weak keyed seen set */
+	lua_newtable(L);
+	lua_createtable(L, 0, 1);
+	lua_pushliteral(L, "k");
+	lua_setfield(L, -2, "__mode");
+	lua_setmetatable(L, -2);
+	lua_rawseti(L, state, SNAPSHOT_SEEN);
+
+	for (i = SNAPSHOT_STACK; i <= SNAPSHOT_SIZE; i++) {
+		lua_newtable(L);
+		lua_rawseti(L, state, i);
+	}
+
+	/* registry names for userdata metatables */
+	lua_rawgeti(L, state, SNAPSHOT_NAMES);
+	lua_pushnil(L);
+	while (lua_next(L, LUA_REGISTRYINDEX) != 0) {
+		if (lua_type(L, -2) == LUA_TSTRING && lua_istable(L, -1)) {
+			lua_pushvalue(L, -2);
+			lua_rawset(L, -4);
+		}
+		else {
+			lua_pop(L, 1);
+		}
+	}
+	lua_pop(L, 1);
+
+	snapshot_top = 0;
+	snapshot_objects = 0;
+
+	/* the snapshot itself is not part of the heap */
+	lua_rawgeti(L, state, SNAPSHOT_SEEN);
+	lua_pushvalue(L, state);
+	lua_pushboolean(L, 1);
+	lua_rawset(L, -3);
+	for (i = SNAPSHOT_SEEN; i <= SNAPSHOT_SIZE; i++) {
+		lua_rawgeti(L, state, i);
+		lua_pushboolean(L, 1);
+		lua_rawset(L, -3);
+	}
+	lua_getfield(L, LUA_REGISTRYINDEX, "heap_debug");
+	if (!lua_isnil(L, -1)) {
+		lua_pushboolean(L, 1);
+		lua_rawset(L, -3);
+	}
+	else {
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	/* roots, the stack is processed last in first out so modules
+	 * are traversed before the globals and registry */
+	lua_pushvalue(L, LUA_REGISTRYINDEX);
+	snapshot_visit(L, state, lua_gettop(L), "registry");
+	lua_pop(L, 1);
+
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
+	snapshot_visit(L, state, lua_gettop(L), "_G");
+	lua_pop(L, 1);
+
+	lua_getglobal(L, "package");
+	if (lua_istable(L, -1)) {
+		lua_getfield(L, -1, "loaded");
+		if (lua_istable(L, -1)) {
+			lua_pushnil(L);
+			while (lua_next(L, -2) != 0) {
+				if (lua_type(L, -2) == LUA_TSTRING) {
+					snapshot_visit(L, state, lua_gettop(L), lua_tostring(L, -2));
+				}
+				lua_pop(L, 1);
+			}
+		}
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	lua_setfield(L, LUA_REGISTRYINDEX, SNAPSHOT_STATE);
+
+	return 0;
+}
+
+
+/*
+ * Continue the heap snapshot for at most the given number of ms
+ * (default 5). Returns nil while the snapshot is in progress, and
+ * the snapshot when it is complete. The snapshot has the fields
+ * count and size, each a table indexed by "type/class/owner", and
+ * objects, the total number of objects found.
+ */
+static int jiveL_heap_snapshot_step(lua_State *L) {
+	Uint32 timeout = jive_jiffies() + luaL_optinteger(L, 1, 5);
+	int state, n = 0;
+
+	lua_settop(L, 0);
+
+	lua_getfield(L, LUA_REGISTRYINDEX, SNAPSHOT_STATE);
+	if (lua_isnil(L, -1)) {
+		return luaL_error(L, "no heap snapshot in progress");
+	}
+	state = lua_gettop(L);
+
+	lua_rawgeti(L, state, SNAPSHOT_STACK);
+	lua_rawgeti(L, state, SNAPSHOT_OWNERS);
+
+	while (snapshot_top > 0) {
+		const char *owner;
+
+		/* check the time every 64 objects */
+		if ((++n & 63) == 0 && (Sint32)(jive_jiffies() - timeout) >= 0) {
+			lua_pushnil(L);
+			return 1;
+		}
+
+		if (!lua_checkstack(L, 8)) {
+			return luaL_error(L, "stack error");
+		}
+
+		lua_rawgeti(L, 3, snapshot_top);
+		owner = lua_tostring(L, -1);
+
+		lua_rawgeti(L, 2, snapshot_top);
+
+		lua_pushnil(L);
+		lua_rawseti(L, 2, snapshot_top);
+		snapshot_top--;
+
+		snapshot_traverse(L, state, owner);
+		lua_pop(L, 2);
+	}
+
+	/* complete */
+	lua_createtable(L, 0, 3);
+	lua_rawgeti(L, state, SNAPSHOT_COUNT);
+	lua_setfield(L, -2, "count");
+	lua_rawgeti(L, state, SNAPSHOT_SIZE);
+	lua_setfield(L, -2, "size");
+	lua_pushinteger(L, snapshot_objects);
+	lua_setfield(L, -2, "objects");
+
+	lua_pushnil(L);
+	lua_setfield(L, LUA_REGISTRYINDEX, SNAPSHOT_STATE);
+
+	return 1;
+}
+
+
+/*
+ * Compare two snapshots, returns a table indexed by "type/class/owner"
+ * with { count = delta, size = delta } for each entry that changed.
+ */
+static int jiveL_heap_diff(lua_State *L) {
+	int pass;
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	lua_settop(L, 2);
+
+	lua_getfield(L, 1, "count");	/* 3 */
+	lua_getfield(L, 1, "size");	/* 4 */
+	lua_getfield(L, 2, "count");	/* 5 */
+	lua_getfield(L, 2, "size");	/* 6 */
+	lua_newtable(L);		/* 7 */
+
+	/* keys in the new snapshot, then keys only in the old one */
+	for (pass = 0; pass < 2; pass++) {
+		int keys = pass ? 3 : 5;
+
+		lua_pushnil(L);
+		while (lua_next(L, keys) != 0) {
+			lua_Integer dc, ds;
+
+			lua_pop(L, 1);
+
+			if (pass) {
+				lua_pushvalue(L, -1);
+				lua_rawget(L, 5);
+				if (!lua_isnil(L, -1)) {
+					lua_pop(L, 1);
+					continue;
+				}
+				lua_pop(L, 1);
+			}
+
+			lua_pushvalue(L, -1);
+			lua_rawget(L, 5);
+			lua_pushvalue(L, -2);
+			lua_rawget(L, 3);
+			dc = lua_tointeger(L, -2) - lua_tointeger(L, -1);
+			lua_pop(L, 2);
+
+			lua_pushvalue(L, -1);
+			lua_rawget(L, 6);
+			lua_pushvalue(L, -2);
+			lua_rawget(L, 4);
+			ds = lua_tointeger(L, -2) - lua_tointeger(L, -1);
+			lua_pop(L, 2);
+
+			if (dc || ds) {
+				lua_pushvalue(L, -1);
+				lua_createtable(L, 0, 2);
+				lua_pushinteger(L, dc);
+				lua_setfield(L, -2, "count");
+				lua_pushinteger(L, ds);
+				lua_setfield(L, -2, "size");
+				lua_rawset(L, 7);
+			}
+		}
+	}
+
+	return 1;
+}
+
+
 static const struct luaL_Reg debug_funcs[] = {
 	{ "perfhook", jiveL_perfhook },
+	{ "profileStart", jiveL_profile_start },
+	{ "profileStop", jiveL_profile_stop },
+	{ "profileDump", jiveL_profile_dump },
 	{ "heap", jiveL_heap },
+	{ "heapSnapshot", jiveL_heap_snapshot },
+	{ "heapSnapshotStep", jiveL_heap_snapshot_step },
+	{ "heapDiff", jiveL_heap_diff },
 	{ NULL, NULL }
 };
 
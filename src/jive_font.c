@@ -279,6 +279,77 @@ JiveSurface *jive_font_draw_text(JiveFont *font, Uint32 color, const char *str)
 	return jive_surface_new_SDLSurface(str ? font->draw(font, color, str) : NULL);
 }
 
+/*
+ * Draw text with its shadow offset by one pixel, composited into a single
+ * surface so it can be kept and drawn with one blit.
+ */
+JiveSurface *jive_font_draw_text_shadow(JiveFont *font, Uint32 fg, Uint32 sh, const char *str) {
+	SDL_Surface *fg_srf, *sh_srf, *srf;
+	SDL_PixelFormat *fmt;
+	int x, y;
+
+	assert(font && font->magic == JIVE_FONT_MAGIC);
+
+	if (!str) {
+		return jive_surface_new_SDLSurface(NULL);
+	}
+
+	fg_srf = font->draw(font, fg, str);
+	sh_srf = font->draw(font, sh, str);
+	if (!fg_srf || !sh_srf) {
+		if (sh_srf) {
+			SDL_FreeSurface(sh_srf);
+		}
+		return jive_surface_new_SDLSurface(fg_srf);
+	}
+
+	fmt = fg_srf->format;
+	srf = SDL_CreateRGBSurface(SDL_SWSURFACE, fg_srf->w + 1, fg_srf->h + 1, 32,
+				   fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	SDL_SetAlpha(srf, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+
+	/* shadow into the transparent surface, then the text over it */
+	for (y = 0; y < sh_srf->h; y++) {
+		memcpy((Uint8 *)srf->pixels + (y + 1) * srf->pitch + 4,
+		       (Uint8 *)sh_srf->pixels + y * sh_srf->pitch, sh_srf->w * 4);
+	}
+
+	for (y = 0; y < fg_srf->h; y++) {
+		Uint32 *sp = (Uint32 *)((Uint8 *)fg_srf->pixels + y * fg_srf->pitch);
+		Uint32 *dp = (Uint32 *)((Uint8 *)srf->pixels + y * srf->pitch);
+
+		for (x = 0; x < fg_srf->w; x++, sp++, dp++) {
+			Uint8 sr, sg, sb, sa, dr, dg, db, da;
+			Uint32 a, w;
+
+			SDL_GetRGBA(*sp, fmt, &sr, &sg, &sb, &sa);
+			if (sa == 0) {
+				continue;
+			}
+			if (sa == 255) {
+				*dp = *sp;
+				continue;
+			}
+
+			SDL_GetRGBA(*dp, fmt, &dr, &dg, &db, &da);
+
+			/* src over dst, dst weighted by its alpha */
+			w = da * (255 - sa) / 255;
+			a = sa + w;
+			*dp = SDL_MapRGBA(fmt,
+					  (sr * sa + dr * w) / a,
+					  (sg * sa + dg * w) / a,
+					  (sb * sa + db * w) / a,
+					  a);
+		}
+	}
+
+	SDL_FreeSurface(fg_srf);
+	SDL_FreeSurface(sh_srf);
+
+	return jive_surface_new_SDLSurface(srf);
+}
+
 JiveSurface *jive_font_ndraw_text(JiveFont *font, Uint32 color, const char *str, size_t len) {
 	char *tmp;
 
@@ -230,6 +230,12 @@ static int jiveL_initSDL(lua_State *L) {
 		pointer_enable = false;
 	}
 
+	/* the benchmark runner is headless, see jive.Bench */
+	if(SDL_getenv("JIVE_BENCH") && !SDL_getenv("SDL_VIDEODRIVER")) {
+		SDL_putenv("SDL_VIDEODRIVER=dummy");
+		pointer_enable = false;
+	}
+
 	LOG_INFO(log_ui_draw, "initSDL");
 	if (atexit(jive_quit) != 0) {
 		LOG_ERROR(log_ui,"jive_quit atexit failed");
@@ -288,12 +294,18 @@ static int jiveL_initSDL(lua_State *L) {
 	
 	if (splash) {
 		jive_surface_get_size(splash, &splash_w, &splash_h);
-		if (video_info->wm_available) {
+		if (video_info->wm_available || screen_w == 0 || screen_h == 0) {
 			screen_w = splash_w;
 			screen_h = splash_h;
 		}
 	}
 
+	/* the dummy driver has no display size, the skin sets the size later */
+	if (screen_w == 0 || screen_h == 0) {
+		screen_w = 480;
+		screen_h = 272;
+	}
+
 	srf = jive_surface_set_video_mode(screen_w, screen_h, screen_bpp, video_info->wm_available ? false : true);
 	if (!srf) {
 		LOG_ERROR(log_ui_draw, "Video mode not supported: %dx%d\n", screen_w, screen_h);
@@ -431,6 +443,7 @@ static int jiveL_process_events(lua_State *L) {
 	process_timers(L);
 	while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_ALLEVENTS) > 0 ) {
 		r |= process_event(L, &event);
+		jive_frame.events++;
 	}
 
 	lua_pop(L, 2);
@@ -478,6 +491,7 @@ int jiveL_set_update_screen(lua_State *L) {
 static int _draw_screen(lua_State *L) {
 	JiveSurface *srf;
 	Uint32 t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+	Uint32 dirty_area = 0;
 	clock_t c0 = 0, c1 = 0;
 	bool_t standalone_draw, drawn = false;
 
@@ -504,8 +518,8 @@ static int _draw_screen(lua_State *L) {
 	}
 	lua_rawgeti(L, -1, 1);	// topwindow
 
+	t0 = jive_usecs();
 	if (perfwarn.screen) {
-		t0 = jive_jiffies();
 		c0 = clock();
 	}
 
@@ -522,7 +536,7 @@ static int _draw_screen(lua_State *L) {
 		/* check in case the origin changes during layout */
 	} while (jive_origin != next_jive_origin);
 
-	if (perfwarn.screen) t1 = jive_jiffies();
+	t1 = jive_usecs();
  
 	/* Widget animations - don't update in a standalone draw as its not the main screen update */
 	if (!standalone_draw) {
@@ -561,7 +575,7 @@ static int _draw_screen(lua_State *L) {
 		lua_pop(L, 1);
 	}
 
-	if (perfwarn.screen) t2 = jive_jiffies();
+	t2 = jive_usecs();
 
 	/* Window transitions */
 	lua_getfield(L, 1, "transition");
@@ -571,7 +585,8 @@ static int _draw_screen(lua_State *L) {
 		jive_tile_set_alpha(jive_background, 0); // no alpha channel
 		jive_tile_blit(jive_background, srf, 0, 0, screen_w, screen_h);
 
-		if (perfwarn.screen) t3 = jive_jiffies();
+		t3 = jive_usecs();
+		dirty_area = screen_w * screen_h;
 		
 		/* Animate screen transition */
 		lua_pushvalue(L, -1);
@@ -588,6 +603,7 @@ static int _draw_screen(lua_State *L) {
 		if (!standalone_draw) {
 			jive_rect_union(&jive_dirty_region, &last_dirty_region, &dirty);
 			jive_surface_set_clip(srf, &dirty);
+			dirty_area = dirty.w * dirty.h;
 		}
 
 #if 0
@@ -595,10 +611,12 @@ static int _draw_screen(lua_State *L) {
 		printf("--> %d,%d %dx%d\n", dirty.x, dirty.y, dirty.w, dirty.h);
 #endif
 
-		/* Draw background */
-		jive_tile_blit(jive_background, srf, 0, 0, screen_w, screen_h);
+		/* Draw background, unless the window covers it */
+		if (!jive_window_is_opaque(L, -2, srf)) {
+			jive_tile_blit(jive_background, srf, 0, 0, screen_w, screen_h);
+		}
 
-		if (perfwarn.screen) t3 = jive_jiffies();
+		t3 = jive_usecs();
 
 		/* Draw screen */
 		if (jive_getmethod(L, -2, "draw")) {
@@ -623,15 +641,26 @@ static int _draw_screen(lua_State *L) {
 		drawn = true;
 	}
 
+	t4 = jive_usecs();
+	if (!t3) {
+		t3 = t2;
+	}
+
+	if (!standalone_draw) {
+		jive_frame.ticks = jive_jiffies();
+		jive_frame.layout = t1 - t0;
+		jive_frame.animate = t2 - t1;
+		jive_frame.background = t3 - t2;
+		jive_frame.draw = t4 - t3;
+		jive_frame.dirty = dirty_area;
+	}
+
 	if (perfwarn.screen) {
-		t4 = jive_jiffies();
 		c1 = clock();
-		if (t4-t0 > perfwarn.screen) {
-			if (!t3) {
-				t3 = t2;
-			}
+		if ((t4-t0) / 1000 > perfwarn.screen) {
 			printf("update_screen > %dms: %4dms (%dms) [layout:%dms animate:%dms background:%dms draw:%dms]\n",
-				   perfwarn.screen, t4-t0, (int)((c1-c0) * 1000 / CLOCKS_PER_SEC), t1-t0, t2-t1, t3-t2, t4-t3);
+				   perfwarn.screen, (t4-t0) / 1000, (int)((c1-c0) * 1000 / CLOCKS_PER_SEC),
+				   (t1-t0) / 1000, (t2-t1) / 1000, (t3-t2) / 1000, (t4-t3) / 1000);
 		}
 	}
 	
@@ -698,7 +727,14 @@ int jiveL_update_screen(lua_State *L) {
 
 	/* flip screen */
 	if (lua_toboolean(L, -1)) {
+		Uint16 w, h;
+		Uint32 t0 = jive_usecs();
+
 		jive_surface_flip(screen);
+
+		jive_surface_get_size(screen, &w, &h);
+		jive_frame.flip = jive_usecs() - t0;
+		jive_frame.pixels = w * h;
 	}
 
 	lua_pop(L, 2);
@@ -1037,12 +1073,37 @@ int jiveL_event(lua_State *L) {
 }
 
 
+/* virtual clock used by the benchmark runner, the ticks seen by lua
+ * only move when it is advanced so timers and animations repeat
+ * exactly from run to run.
+ */
+static bool virtual_clock = false;
+static Uint32 virtual_ticks = 0;
+
 int jiveL_get_ticks(lua_State *L) {
-	lua_pushinteger(L, jive_jiffies());
+	lua_pushinteger(L, virtual_clock ? virtual_ticks : jive_jiffies());
 	return 1;
 }
 
 
+int jiveL_set_virtual_clock(lua_State *L) {
+	/* stack is:
+	 * 1: framework
+	 * 2: ticks, or nil to go back to the real clock
+	 */
+
+	if (lua_isnoneornil(L, 2)) {
+		virtual_clock = false;
+	}
+	else {
+		virtual_clock = true;
+		virtual_ticks = luaL_checkinteger(L, 2);
+	}
+
+	return 0;
+}
+
+
 int jiveL_thread_time(lua_State *L) {
 	lua_pushinteger(L, (int)(clock() * 1000 / CLOCKS_PER_SEC));
 	return 1;
@@ -1599,6 +1660,13 @@ static const struct luaL_Reg surface_methods[] = {
 	{ "newRGBA", jiveL_surface_newRGBA },
 	{ "loadImage", jiveL_surface_load_image },
 	{ "loadImageData", jiveL_surface_load_image_data },
+	{ "loadImageScaled", jiveL_surface_load_image_scaled },
+	{ "loadImageDataScaled", jiveL_surface_load_image_data_scaled },
+	{ "setCacheBudget", jiveL_surface_set_cache_budget },
+	{ "getCacheStats", jiveL_surface_get_cache_stats },
+	{ "acquire", jiveL_surface_acquire },
+	{ "setPoolBudget", jiveL_surface_set_pool_budget },
+	{ "getPoolStats", jiveL_surface_get_pool_stats },
 	{ "drawText", jiveL_surface_draw_text },
 	{ "free", jiveL_surface_free },
 	{ "release", jiveL_surface_release },
@@ -1614,6 +1682,8 @@ static const struct luaL_Reg surface_methods[] = {
 	{ "getBytes", jiveL_surface_get_bytes },
 	{ "rotozoom", jiveL_surface_rotozoomSurface },
 	{ "zoom", jiveL_surface_zoomSurface },
+	{ "rotozoomCached", jiveL_surface_rotozoom_cached },
+	{ "zoomCached", jiveL_surface_zoom_cached },
 	{ "shrink", jiveL_surface_shrinkSurface },
 	{ "resize", jiveL_surface_resize },
 	{ "pixel", jiveL_surface_pixelColor },
@@ -1660,12 +1730,18 @@ static const struct luaL_Reg core_methods[] = {
 	{ "pushEvent", jiveL_push_event },
 	{ "dispatchEvent", jiveL_dispatch_event },
 	{ "getTicks", jiveL_get_ticks },
+	{ "setVirtualClock", jiveL_set_virtual_clock },
 	{ "threadTime", jiveL_thread_time },
 	{ "setVideoMode", jiveL_set_video_mode },
 	{ "getBackground", jiveL_get_background },
 	{ "setBackground", jiveL_set_background },
 	{ "styleChanged", jiveL_style_changed },
 	{ "perfwarn", jiveL_perfwarn },
+	{ "getFrameStats", jiveL_get_frame_stats },
+	{ "dumpFrameStats", jiveL_dump_frame_stats },
+	{ "resetFrameStats", jiveL_reset_frame_stats },
+	{ "_gcStep", jiveL_gc_step },
+	{ "_commitFrameStats", jiveL_commit_frame_stats },
 	{ "_event", jiveL_event },
 	{ NULL, NULL }
 };
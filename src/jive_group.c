@@ -61,6 +61,13 @@ int jiveL_group_iterate(lua_State *L) {
 }
 
 
+static void opaque_bounds(JiveWidget *w, SDL_Rect *r) {
+	GroupWidget *peer = (GroupWidget *) w;
+
+	jive_widget_opaque_tile(w, peer->bg_tile, r);
+}
+
+
 int jiveL_group_skin(lua_State *L) {
 	GroupWidget *peer;
 	JiveTile *bg_tile;
@@ -76,6 +83,7 @@ int jiveL_group_skin(lua_State *L) {
 	peer = jive_getpeer(L, 1, &groupPeerMeta);
 
 	jive_widget_pack(L, 1, (JiveWidget *)peer);
+	peer->w.opaque = opaque_bounds;
 
 
 	bg_tile = jive_style_tile(L, 1, "bgImg", NULL);
@@ -38,6 +38,24 @@ static JivePeerMeta iconPeerMeta = {
 
 
 
+static void opaque_bounds(JiveWidget *w, SDL_Rect *r) {
+	IconWidget *peer = (IconWidget *) w;
+	SDL_Rect img;
+
+	jive_widget_opaque_tile(w, peer->bg_tile, r);
+	if (r->w || !peer->img || !jive_surface_is_opaque(peer->img)) {
+		return;
+	}
+
+	/* the image is drawn clipped to the bounds */
+	img.x = peer->w.bounds.x + peer->offset_x;
+	img.y = peer->w.bounds.y + peer->offset_y;
+	img.w = peer->image_width;
+	img.h = peer->image_height;
+	jive_rect_intersection(&img, &peer->w.bounds, r);
+}
+
+
 int jiveL_icon_skin(lua_State *L) {
 	IconWidget *peer;
 	JiveTile *bg_tile;
@@ -53,6 +71,7 @@ int jiveL_icon_skin(lua_State *L) {
 
 	peer = jive_getpeer(L, 1, &iconPeerMeta);
 	jive_widget_pack(L, 1, (JiveWidget *)peer);
+	peer->w.opaque = opaque_bounds;
 
 
 	/* default image from style */
@@ -0,0 +1,291 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "common.h"
+#include "jive.h"
+
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <png.h>
+
+/*
+ * Decode large images at a reduced size, so a photo or cover is never
+ * held in memory at full resolution. A JPEG is scaled by 1/2, 1/4 or 1/8
+ * in the IDCT, and a PNG is box filtered a row at a time as it is read.
+ * The image is reduced as far as it can be while staying at least w by h,
+ * the caller resamples it to the exact size it needs.
+ *
+ * NULL is returned for other formats, interlaced PNGs, and images that
+ * are too small to reduce, these are left to SDL_image.
+ */
+
+#define MAX_REDUCTION 8
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+#define RMASK 0xFF000000
+#define GMASK 0x00FF0000
+#define BMASK 0x0000FF00
+#define AMASK 0x000000FF
+#else
+#define RMASK 0x000000FF
+#define GMASK 0x0000FF00
+#define BMASK 0x00FF0000
+#define AMASK 0xFF000000
+#endif
+
+
+/* largest power of two reduction that keeps the image at least w by h */
+static int _reduction(Uint32 sw, Uint32 sh, Uint16 w, Uint16 h) {
+	int d = 1;
+
+	while (d < MAX_REDUCTION
+	       && (sw + 2 * d - 1) / (2 * d) >= w
+	       && (sh + 2 * d - 1) / (2 * d) >= h) {
+		d *= 2;
+	}
+
+	return d;
+}
+
+
+struct jpeg_error {
+	struct jpeg_error_mgr mgr;
+	jmp_buf jmp;
+};
+
+
+static void _jpeg_error_exit(j_common_ptr cinfo) {
+	struct jpeg_error *err = (struct jpeg_error *) cinfo->err;
+	char buf[JMSG_LENGTH_MAX];
+
+	(*cinfo->err->format_message)(cinfo, buf);
+	LOG_WARN(log_ui_draw, "Error decoding jpeg: %s", buf);
+
+	longjmp(err->jmp, 1);
+}
+
+
+static void _jpeg_output_message(j_common_ptr cinfo) {
+	/* corrupt data warnings are common, and not worth logging */
+}
+
+
+static SDL_Surface *_decode_jpeg(const char *data, size_t len, Uint16 w, Uint16 h) {
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error jerr;
+	SDL_Surface *volatile srf = NULL;
+	JSAMPLE *volatile row = NULL;
+	int d;
+
+	cinfo.err = jpeg_std_error(&jerr.mgr);
+	jerr.mgr.error_exit = _jpeg_error_exit;
+	jerr.mgr.output_message = _jpeg_output_message;
+
+	if (setjmp(jerr.jmp)) {
+		jpeg_destroy_decompress(&cinfo);
+		if (srf) {
+			SDL_FreeSurface(srf);
+		}
+		free(row);
+		return NULL;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char *) data, len);
+	jpeg_read_header(&cinfo, TRUE);
+
+	d = _reduction(cinfo.image_width, cinfo.image_height, w, h);
+
+	/* CMYK needs inverting, SDL_image knows how */
+	if (d == 1 || cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+		jpeg_destroy_decompress(&cinfo);
+		return NULL;
+	}
+
+	cinfo.out_color_space = JCS_RGB;
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = d;
+
+	jpeg_start_decompress(&cinfo);
+
+	LOG_DEBUG(log_ui_draw, "jpeg %dx%d decoded at 1/%d %dx%d", cinfo.image_width, cinfo.image_height, d, cinfo.output_width, cinfo.output_height);
+
+	srf = SDL_CreateRGBSurface(SDL_SWSURFACE, cinfo.output_width, cinfo.output_height, 32, RMASK, GMASK, BMASK, 0);
+	row = malloc(cinfo.output_width * 3);
+	if (!srf || !row) {
+		longjmp(jerr.jmp, 1);
+	}
+
+	while (cinfo.output_scanline < cinfo.output_height) {
+		Uint32 *dst = (Uint32 *) ((Uint8 *) srf->pixels + cinfo.output_scanline * srf->pitch);
+		JSAMPLE *src = row;
+		JDIMENSION x;
+
+		jpeg_read_scanlines(&cinfo, (JSAMPARRAY) &row, 1);
+
+		for (x = 0; x < cinfo.output_width; x++) {
+			*dst++ = SDL_MapRGB(srf->format, src[0], src[1], src[2]);
+			src += 3;
+		}
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	free(row);
+
+	return srf;
+}
+
+
+struct png_source {
+	const char *data;
+	size_t len, pos;
+};
+
+
+static void _png_read(png_structp png, png_bytep buf, png_size_t n) {
+	struct png_source *src = png_get_io_ptr(png);
+
+	if (n > src->len - src->pos) {
+		png_error(png, "truncated");
+	}
+
+	memcpy(buf, src->data + src->pos, n);
+	src->pos += n;
+}
+
+
+static void _png_warning(png_structp png, png_const_charp msg) {
+}
+
+
+static void _png_error(png_structp png, png_const_charp msg) {
+	LOG_WARN(log_ui_draw, "Error decoding png: %s", msg);
+	longjmp(png_jmpbuf(png), 1);
+}
+
+
+static SDL_Surface *_decode_png(const char *data, size_t len, Uint16 w, Uint16 h) {
+	struct png_source src = { data, len, 0 };
+	png_structp png;
+	png_infop info;
+	png_uint_32 sw, sh, y;
+	SDL_Surface *volatile srf = NULL;
+	png_bytep volatile row = NULL;
+	Uint32 *volatile sum = NULL;
+	int d, dw, dh, bit_depth, color_type, interlace;
+
+	png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, _png_error, _png_warning);
+	if (!png) {
+		return NULL;
+	}
+
+	info = png_create_info_struct(png);
+	if (!info) {
+		png_destroy_read_struct(&png, NULL, NULL);
+		return NULL;
+	}
+
+	if (setjmp(png_jmpbuf(png))) {
+		png_destroy_read_struct(&png, &info, NULL);
+		if (srf) {
+			SDL_FreeSurface(srf);
+		}
+		free(row);
+		free(sum);
+		return NULL;
+	}
+
+	png_set_read_fn(png, &src, _png_read);
+	png_read_info(png, info);
+	png_get_IHDR(png, info, &sw, &sh, &bit_depth, &color_type, &interlace, NULL, NULL);
+
+	d = _reduction(sw, sh, w, h);
+
+	/* interlaced rows are only complete after the last pass */
+	if (d == 1 || interlace != PNG_INTERLACE_NONE) {
+		png_destroy_read_struct(&png, &info, NULL);
+		return NULL;
+	}
+
+	/* always read 8 bit RGBA */
+	png_set_expand(png);
+	png_set_strip_16(png);
+	png_set_gray_to_rgb(png);
+	png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+	png_read_update_info(png, info);
+
+	dw = (sw + d - 1) / d;
+	dh = (sh + d - 1) / d;
+
+	LOG_DEBUG(log_ui_draw, "png %dx%d decoded at 1/%d %dx%d", sw, sh, d, dw, dh);
+
+	srf = SDL_CreateRGBSurface(SDL_SWSURFACE, dw, dh, 32, RMASK, GMASK, BMASK, AMASK);
+	row = malloc(sw * 4);
+	sum = calloc(dw * 4, sizeof(Uint32));
+	if (!srf || !row || !sum) {
+		png_error(png, "out of memory");
+	}
+
+	for (y = 0; y < sh; y++) {
+		png_bytep p = row;
+		png_uint_32 x;
+
+		png_read_row(png, row, NULL);
+
+		/* colour is weighted by alpha, so transparent pixels do not darken the edges */
+		for (x = 0; x < sw; x++) {
+			Uint32 *s = sum + (x / d) * 4;
+			Uint32 a = p[3];
+
+			s[0] += p[0] * a;
+			s[1] += p[1] * a;
+			s[2] += p[2] * a;
+			s[3] += a;
+			p += 4;
+		}
+
+		if ((y + 1) % d == 0 || y + 1 == sh) {
+			Uint32 *dst = (Uint32 *) ((Uint8 *) srf->pixels + (y / d) * srf->pitch);
+			Uint32 rows = y % d + 1;
+			int i;
+
+			for (i = 0; i < dw; i++) {
+				Uint32 *s = sum + i * 4;
+				Uint32 n = rows * ((i + 1) * d <= (int) sw ? d : sw - i * d);
+
+				if (s[3]) {
+					dst[i] = SDL_MapRGBA(srf->format, s[0] / s[3], s[1] / s[3], s[2] / s[3], s[3] / n);
+				}
+				else {
+					dst[i] = 0;
+				}
+			}
+
+			memset(sum, 0, dw * 4 * sizeof(Uint32));
+		}
+	}
+
+	png_read_end(png, NULL);
+	png_destroy_read_struct(&png, &info, NULL);
+	free(row);
+	free(sum);
+
+	return srf;
+}
+
+
+SDL_Surface *jive_image_decode_scaled(const char *data, size_t len, Uint16 w, Uint16 h) {
+	if (len > 2 && (Uint8) data[0] == 0xFF && (Uint8) data[1] == 0xD8) {
+		return _decode_jpeg(data, len, w, h);
+	}
+
+	if (len > 8 && png_sig_cmp((png_bytep) data, 0, 8) == 0) {
+		return _decode_png(data, len, w, h);
+	}
+
+	return NULL;
+}
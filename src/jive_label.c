@@ -70,6 +70,13 @@ static void jive_label_gc_lines(LabelWidget *peer);
 static void jive_label_gc_formats(LabelWidget *format);
 
 
+static void opaque_bounds(JiveWidget *w, SDL_Rect *r) {
+	LabelWidget *peer = (LabelWidget *) w;
+
+	jive_widget_opaque_tile(w, peer->bg_tile, r);
+}
+
+
 int jiveL_label_skin(lua_State *L) {
 	LabelWidget *peer;
 	JiveTile *bg_tile;
@@ -86,6 +93,7 @@ int jiveL_label_skin(lua_State *L) {
 	peer = jive_getpeer(L, 1, &labelPeerMeta);
 
 	jive_widget_pack(L, 1, (JiveWidget *)peer);
+	peer->w.opaque = opaque_bounds;
 
 	jive_label_gc_formats(peer);
 
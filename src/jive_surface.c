@@ -34,6 +34,7 @@ struct image {
 	Uint16 flags;
 #   define IMAGE_FLAG_INIT  (1<<0)			/* Have w & h been evaluated yet */
 #   define IMAGE_FLAG_AMASK (1<<1)
+#   define IMAGE_FLAG_OPAQUE (1<<2)			/* every pixel is opaque, known once loaded */
 	Uint16 ref_count;
 #ifdef JIVE_PROFILE_IMAGE_CACHE
 	Uint16 use_count;
@@ -69,13 +70,109 @@ struct jive_surface {
 #   define TILE_FLAG_INIT  (1<<0)		/* Have w & h been evaluated yet */
 #   define TILE_FLAG_BG    (1<<1)
 #   define TILE_FLAG_ALPHA (1<<2)		/* have alpha flags been set of this tile */
-#   define TILE_FLAG_spare (1<<3)
+#   define TILE_FLAG_POOLED (1<<3)		/* sdl surface goes back to the pool when freed */
 #   define TILE_FLAG_IMAGE (1<<4)		/* just a single image */
 #   define TILE_FLAG_TILE  (1<<5)		/* multiple images */
 };
 
 #define IS_DYNAMIC_IMAGE(tile) ((tile)->flags & (TILE_FLAG_IMAGE | TILE_FLAG_TILE))
 
+/*
+ * Images decoded from data are shared by everything loading the same bytes
+ * at the same size, so artwork fetched from several servers or shown by
+ * several windows is only decoded and resized once. The cache keeps its own
+ * surface for each image and hands out new surfaces sharing its pixels, so
+ * offsets, alpha and release() stay with each user. The oldest pixels no
+ * one else is using are dropped when the decoded bytes go over budget.
+ * Surfaces from the cache must not be drawn on.
+ */
+struct decoded_image {
+	Uint64 hash;								/* of the image data */
+	size_t len;
+	Uint16 w, h;								/* size asked for, 0 for the image size */
+	JiveSurface *srf;
+	int bytes;
+	struct decoded_image *prev, *next;			/* LRU, most recent first */
+};
+
+#define DECODED_BUDGET		(16 * 1024 * 1024)
+
+static struct decoded_image *decodedHead, *decodedTail;
+static size_t decoded_bytes, decoded_budget = DECODED_BUDGET;
+static Uint32 decoded_entries, decoded_hits, decoded_misses, decoded_evictions;
+
+/*
+ * Rotated and zoomed copies of surfaces, such as clock hands, so each
+ * position is only rendered once. Angles are quantised to 1/4 degree and
+ * zooms to 1/1024. The oldest idle sprites are dropped when over budget,
+ * and all sprites of a surface when it is freed. The source is not
+ * referenced, only used as the key.
+ */
+struct sprite {
+	JiveSurface *src;
+	Sint32 angle, zoomx, zoomy;					/* quantised */
+	int smooth;
+	JiveSurface *srf;
+	int bytes;
+	struct sprite *prev, *next;					/* LRU, most recent first */
+};
+
+#define SPRITE_BUDGET		(4 * 1024 * 1024)
+#define SPRITE_ANGLE_STEPS	4
+#define SPRITE_ZOOM_STEPS	1024
+
+static struct sprite *spriteHead, *spriteTail;
+static size_t sprite_bytes;
+
+static void _sprite_purge(JiveSurface *src);
+
+/*
+ * Idle full screen and other large temporary surfaces, such as window
+ * transition buffers and slideshow frames, kept for reuse rather than
+ * freed. Surfaces from jive_surface_acquire() return here when freed or
+ * released, and are matched on size and format when next acquired. The
+ * oldest idle surfaces are freed when over budget.
+ */
+struct pooled_surface {
+	SDL_Surface *sdl;
+	int bytes;
+	struct pooled_surface *prev, *next;			/* most recently pooled first */
+};
+
+#define POOL_BUDGET		(8 * 1024 * 1024)
+
+static struct pooled_surface *poolHead, *poolTail;
+static size_t pool_bytes, pool_budget = POOL_BUDGET;
+static Uint32 pool_acquires, pool_hits, pool_returns, pool_evictions;
+
+static void _pool_put(SDL_Surface *sdl);
+static void _surface_put_sdl(JiveSurface *srf);
+static JiveSurface *_surface_share(SDL_Surface *sdl);
+
+/*
+ * Tiles drawn from nine images, such as menu item backgrounds and buttons,
+ * composed into one surface for the sizes they are drawn at, so redrawing
+ * them is a single blit. A size is only composed the second time it is
+ * drawn, so tiles drawn at ever changing sizes, such as slider bars, are
+ * not composed at all. A few sizes are kept for each tile, and the oldest
+ * are dropped when over budget.
+ */
+struct composed_tile {
+	JiveTile *tile;
+	Uint16 w, h;
+	SDL_Surface *sdl;							/* NULL until drawn twice */
+	int bytes;
+	struct composed_tile *prev, *next;			/* LRU, most recent first */
+};
+
+#define COMPOSED_BUDGET		(4 * 1024 * 1024)
+#define COMPOSED_SIZES		3					/* per tile */
+
+static struct composed_tile *composedHead, *composedTail;
+static size_t composed_bytes;
+
+static void _composed_purge(JiveTile *tile);
+
 static int _new_image(const char *path) {
 	Uint16 i;
 
@@ -190,6 +287,32 @@ static void _use_image(Uint16 index) {
 	}
 }
 
+/* check the alpha channel of a newly loaded image */
+static bool _is_opaque_image(SDL_Surface *srf) {
+	SDL_PixelFormat *fmt = srf->format;
+	int x, y;
+
+	if (!fmt->Amask) {
+		return !(srf->flags & SDL_SRCCOLORKEY);
+	}
+
+	if (fmt->BytesPerPixel != 4 || SDL_MUSTLOCK(srf)) {
+		return false;
+	}
+
+	for (y = 0; y < srf->h; y++) {
+		Uint32 *p = (Uint32 *) ((Uint8 *) srf->pixels + y * srf->pitch);
+
+		for (x = 0; x < srf->w; x++) {
+			if ((p[x] & fmt->Amask) != fmt->Amask) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 static void _load_image (Uint16 index, bool hasAlphaFlags, Uint32 alphaFlags) {
 	struct image *image = &images[index];
 	SDL_Surface *tmp, *srf;
@@ -210,6 +333,10 @@ static void _load_image (Uint16 index, bool hasAlphaFlags, Uint32 alphaFlags) {
 	if (!srf)
 		return;
 
+	if (_is_opaque_image(srf)) {
+		image->flags |= IMAGE_FLAG_OPAQUE;
+	}
+
 	if (hasAlphaFlags) {
 		SDL_SetAlpha(srf, alphaFlags, 0);
 	}
@@ -467,31 +594,14 @@ JiveTile *jive_tile_load_image(const char *path) {
 
 JiveTile *jive_tile_load_image_data(const char *data, size_t len) {
 	JiveTile *tile;
-	SDL_Surface *tmp, *srf;
-	SDL_RWops *src;
-
-	tile = calloc(sizeof(JiveTile), 1);
-	tile->refcount = 1;
 
-	src = SDL_RWFromConstMem(data, (int) len);
-	tmp = IMG_Load_RW(src, 1);
+	tile = jive_surface_load_image_data(data, len);
 
-	if (!tmp) {
+	if (!tile->sdl) {
 		LOG_WARN(log_ui_draw, "Error loading tile: %s\n", IMG_GetError());
-		free(tile);
+		jive_tile_free(tile);
 		return NULL;
 	}
-	else {
-		if (tmp->format->Amask) {
-			srf = SDL_DisplayFormatAlpha(tmp);
-		}
-		else {
-			srf = SDL_DisplayFormat(tmp);
-		}
-		SDL_FreeSurface(tmp);
-	}
-
-	tile->sdl = srf;
 
 	return tile;
 }
@@ -577,15 +687,69 @@ void jive_tile_get_min_size(JiveTile *tile, Uint16 *w, Uint16 *h) {
 	if (h) *h = tile->h[0] + tile->h[1];
 }
 
+/*
+ * Does drawing the tile cover its whole area with opaque pixels? Images
+ * from files are only known to be opaque once they have been loaded.
+ */
+bool jive_tile_is_opaque(JiveTile *tile) {
+	int i;
+
+	if (tile->flags & TILE_FLAG_BG) {
+		return (tile->bg & 0xFF) == SDL_ALPHA_OPAQUE;
+	}
+
+	if (tile->sdl) {
+		/* surfaces can be drawn on, so the alpha channel is not checked */
+		if (tile->sdl->flags & SDL_SRCCOLORKEY) {
+			return false;
+		}
+		if (!(tile->sdl->flags & SDL_SRCALPHA)) {
+			return true;
+		}
+		return !tile->sdl->format->Amask && tile->sdl->format->alpha == SDL_ALPHA_OPAQUE;
+	}
+
+	if (tile->flags & TILE_FLAG_IMAGE) {
+		return tile->image[0] && (images[tile->image[0]].flags & IMAGE_FLAG_OPAQUE);
+	}
+
+	/* the edges and centre must all be there */
+	for (i = 0; i < 9; i++) {
+		if (!tile->image[i] || !(images[tile->image[i]].flags & IMAGE_FLAG_OPAQUE)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void jive_tile_set_alpha(JiveTile *tile, Uint32 flags) {
 	SDL_Surface *srf[9];
 	int i;
 
 	if (tile->sdl) {
+		/* pixels shared with a cache get a copy of their own first */
+		if (tile->sdl->refcount > 1) {
+			SDL_Surface *sdl = SDL_ConvertSurface(tile->sdl, tile->sdl->format, tile->sdl->flags);
+
+			if (sdl) {
+				_surface_put_sdl(tile);
+				tile->sdl = sdl;
+				tile->flags &= ~TILE_FLAG_POOLED;
+			}
+		}
+
 		SDL_SetAlpha(tile->sdl, flags, 0);
 		return;
 	}
 
+	/* images are shared, so a change may change other tiles too. the
+	 * background is set on every transition frame, unchanged
+	 */
+	if (composedHead && (!(tile->flags & TILE_FLAG_ALPHA) || tile->alpha_flags != flags)) {
+		_composed_purge(NULL);
+	}
+
 	tile->alpha_flags = flags;
 	tile->flags |= TILE_FLAG_ALPHA;
 
@@ -604,9 +768,16 @@ void jive_tile_free(JiveTile *tile) {
 		return;
 	}
 
+	if (spriteHead) {
+		_sprite_purge(tile);
+	}
+
+	if (composedHead) {
+		_composed_purge(tile);
+	}
+
 	if (tile->sdl) {
-		SDL_FreeSurface (tile->sdl);
-		tile->sdl = NULL;
+		_surface_put_sdl(tile);
 	}
 
 	else for (i=0; i<9; i++) {
@@ -656,7 +827,7 @@ static __inline__ void blit_area(SDL_Surface *src, SDL_Surface *dst, int dx, int
 			dr.x = x;
 			dr.y = y;
 
-			SDL_BlitSurface(src, &sr, dst, &dr);
+			jive_blend_blit(src, &sr, dst, &dr);
 
 			x += tw;
 			w -= tw;
@@ -675,93 +846,337 @@ void jive_surface_get_tile_blit(JiveSurface *srf, SDL_Surface **sdl, Sint16 *x,
 }
 
 
-static void _blit_tile(JiveTile *tile, JiveSurface *dst, Uint16 dx, Uint16 dy, Uint16 dw, Uint16 dh) {
-	int ox=0, oy=0, ow=0, oh=0;
-	Sint16 dst_offset_x, dst_offset_y;
-	SDL_Surface *dst_srf;
-	SDL_Surface *srf[9];
-
-	if (tile->flags & TILE_FLAG_BG) {
-		jive_surface_boxColor(dst, dx, dy, dx + dw - 1, dy + dh - 1, tile->bg);
-		return;
-	}
-
-	jive_surface_get_tile_blit(dst, &dst_srf, &dst_offset_x, &dst_offset_y);
-
-	dx += dst_offset_x;
-	dy += dst_offset_y;
-
-	if (tile->sdl) {
-		/* simple, data-loaded image */
-		blit_area(tile->sdl, dst_srf, dx, dy, dw, dh);
-		return;
-	}
-
-	_get_tile_surfaces(tile, srf, true);
-	_init_tile_sizes(tile);
+typedef void (*area_fn)(SDL_Surface *src, SDL_Surface *dst, int dx, int dy, int dw, int dh);
 
-	if ((tile->flags & TILE_FLAG_IMAGE) && srf[0]) {
-		/* dynamically-loaded image */
-		blit_area(srf[0], dst_srf, dx, dy, dw, dh);
-		return;
-	}
+static void _blit_pieces(JiveTile *tile, SDL_Surface *srf[9], SDL_Surface *dst_srf, int dx, int dy, int dw, int dh, area_fn area) {
+	int ox=0, oy=0, ow=0, oh=0;
 
 	/* top left */
 	if (srf[1]) {
 		ox = MIN(tile->w[0], dw);
 		oy = MIN(tile->h[0], dh);
-		blit_area(srf[1], dst_srf, dx, dy, ox, oy);
+		area(srf[1], dst_srf, dx, dy, ox, oy);
 	}
 
 	/* top right */
 	if (srf[3]) {
 		ow = MIN(tile->w[1], dw);
 		oy = MIN(tile->h[0], dh);
-		blit_area(srf[3], dst_srf, dx + dw - ow, dy, ow, oy);
+		area(srf[3], dst_srf, dx + dw - ow, dy, ow, oy);
 	}
 
 	/* bottom right */
 	if (srf[5]) {
 		ow = MIN(tile->w[1], dw);
 		oh = MIN(tile->h[1], dh);
-		blit_area(srf[5], dst_srf, dx + dw - ow, dy + dh - oh, ow, oh);
+		area(srf[5], dst_srf, dx + dw - ow, dy + dh - oh, ow, oh);
 	}
 
 	/* bottom left */
 	if (srf[7]) {
 		ox = MIN(tile->w[0], dw);
 		oh = MIN(tile->h[1], dh);
-		blit_area(srf[7], dst_srf, dx, dy + dh - oh, ox, oh);
+		area(srf[7], dst_srf, dx, dy + dh - oh, ox, oh);
 	}
 
 	/* top */
 	if (srf[2]) {
 		oy = MIN(tile->h[0], dh);
-		blit_area(srf[2], dst_srf, dx + ox, dy, dw - ox - ow, oy);
+		area(srf[2], dst_srf, dx + ox, dy, dw - ox - ow, oy);
 	}
 
 	/* right */
 	if (srf[4]) {
 		ow = MIN(tile->w[1], dw);
-		blit_area(srf[4], dst_srf, dx + dw - ow, dy + oy, ow, dh - oy - oh);
+		area(srf[4], dst_srf, dx + dw - ow, dy + oy, ow, dh - oy - oh);
 	}
 
 	/* bottom */
 	if (srf[6]) {
 		oh = MIN(tile->h[1], dh);
-		blit_area(srf[6], dst_srf, dx + ox, dy + dh - oh, dw - ox - ow, oh);
+		area(srf[6], dst_srf, dx + ox, dy + dh - oh, dw - ox - ow, oh);
 	}
 
 	/* left */
 	if (srf[8]) {
 		ox = MIN(tile->w[0], dw);
-		blit_area(srf[8], dst_srf, dx, dy + oy, ox, dh - oy - oh);
+		area(srf[8], dst_srf, dx, dy + oy, ox, dh - oy - oh);
 	}
 
 	/* center */
 	if (srf[0]) {
-		blit_area(srf[0], dst_srf, dx + ox, dy + oy, dw - ox - ow, dh - oy - oh);
+		area(srf[0], dst_srf, dx + ox, dy + oy, dw - ox - ow, dh - oy - oh);
+	}
+}
+
+
+static void _composed_unlink(struct composed_tile *entry) {
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	}
+	else {
+		composedHead = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	}
+	else {
+		composedTail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+	composed_bytes -= entry->bytes;
+}
+
+
+static void _composed_push(struct composed_tile *entry) {
+	entry->prev = NULL;
+	entry->next = composedHead;
+
+	if (composedHead) {
+		composedHead->prev = entry;
+	}
+	else {
+		composedTail = entry;
+	}
+	composedHead = entry;
+	composed_bytes += entry->bytes;
+}
+
+
+static void _composed_drop(struct composed_tile *entry) {
+	_composed_unlink(entry);
+	if (entry->sdl) {
+		SDL_FreeSurface(entry->sdl);
+	}
+	free(entry);
+}
+
+
+/* drop the composed sizes of a tile, or of all tiles if NULL */
+static void _composed_purge(JiveTile *tile) {
+	struct composed_tile *entry, *next;
+
+	for (entry = composedHead; entry; entry = next) {
+		next = entry->next;
+
+		if (!tile || entry->tile == tile) {
+			_composed_drop(entry);
+		}
+	}
+}
+
+
+/* find the entry for this size, remembering the size if it is new */
+static struct composed_tile *_composed_find(JiveTile *tile, Uint16 w, Uint16 h) {
+	struct composed_tile *entry, *prev;
+	int n = 0;
+
+	for (entry = composedHead; entry; entry = entry->next) {
+		if (entry->tile == tile && entry->w == w && entry->h == h) {
+			if (entry != composedHead) {
+				_composed_unlink(entry);
+				_composed_push(entry);
+			}
+			return entry;
+		}
+	}
+
+	entry = calloc(sizeof(struct composed_tile), 1);
+	if (!entry) {
+		return NULL;
+	}
+
+	entry->tile = tile;
+	entry->w = w;
+	entry->h = h;
+	_composed_push(entry);
+
+	/* keep the most recent sizes of this tile */
+	for (entry = composedHead; entry; entry = entry->next) {
+		if (entry->tile == tile) {
+			n++;
+		}
+	}
+
+	for (entry = composedTail; entry && n > COMPOSED_SIZES; entry = prev) {
+		prev = entry->prev;
+
+		if (entry->tile == tile) {
+			_composed_drop(entry);
+			n--;
+		}
+	}
+
+	return NULL;
+}
+
+
+/* copy the image over the area, with alpha if it is blended */
+static void copy_area(SDL_Surface *src, SDL_Surface *dst, int dx, int dy, int dw, int dh) {
+	Uint32 opaque;
+	int x, y, w, i;
+
+	opaque = (src->format->Amask && (src->flags & SDL_SRCALPHA)) ? 0 : dst->format->Amask;
+
+	dw = MIN(dw, dst->w - dx);
+	dh = MIN(dh, dst->h - dy);
+
+	for (y = 0; y < dh; y++) {
+		Uint32 *s = (Uint32 *) ((Uint8 *) src->pixels + (y % src->h) * src->pitch);
+		Uint32 *d = (Uint32 *) ((Uint8 *) dst->pixels + (dy + y) * dst->pitch) + dx;
+
+		for (x = 0; x < dw; x += w) {
+			w = MIN(src->w, dw - x);
+
+			if (opaque) {
+				for (i = 0; i < w; i++) {
+					d[x + i] = s[i] | opaque;
+				}
+			}
+			else {
+				memcpy(d + x, s, w * sizeof(Uint32));
+			}
+		}
+	}
+}
+
+
+/*
+ * Compose the tile images into one surface, or return NULL if they can
+ * not be copied directly. The images must be 32 bit in the same format,
+ * and must not overlap at this size.
+ */
+static SDL_Surface *_compose_tile(JiveTile *tile, SDL_Surface *srf[9], Uint16 dw, Uint16 dh) {
+	SDL_PixelFormat *fmt = NULL;
+	SDL_Surface *sdl;
+	bool alpha = false;
+	int i;
+
+	if (dw < tile->w[0] + tile->w[1] || dh < tile->h[0] + tile->h[1]
+	    || dw * dh * 4 > COMPOSED_BUDGET / 4) {
+		return NULL;
+	}
+
+	for (i = 0; i < 9; i++) {
+		SDL_PixelFormat *f;
+
+		if (!srf[i]) {
+			/* the background shows through */
+			alpha = true;
+			continue;
+		}
+
+		f = srf[i]->format;
+		if (f->BytesPerPixel != 4
+		    || (fmt && (f->Rmask != fmt->Rmask || f->Gmask != fmt->Gmask || f->Bmask != fmt->Bmask))
+		    || (f->Amask && f->Amask != 0xFF000000)
+		    || (srf[i]->flags & (SDL_SRCCOLORKEY | SDL_RLEACCEL))
+		    || SDL_MUSTLOCK(srf[i])) {
+			return NULL;
+		}
+
+		if (srf[i]->flags & SDL_SRCALPHA) {
+			if (f->Amask) {
+				alpha = true;
+			}
+			else if (f->alpha != SDL_ALPHA_OPAQUE) {
+				return NULL;
+			}
+		}
+
+		fmt = f;
+	}
+
+	if (!fmt) {
+		return NULL;
+	}
+
+	sdl = SDL_CreateRGBSurface(SDL_SWSURFACE, dw, dh, 32,
+				   fmt->Rmask, fmt->Gmask, fmt->Bmask, alpha ? 0xFF000000 : 0);
+	if (!sdl) {
+		return NULL;
+	}
+
+	if (alpha) {
+		SDL_SetAlpha(sdl, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+	}
+
+	_blit_pieces(tile, srf, sdl, 0, 0, dw, dh, copy_area);
+
+	return sdl;
+}
+
+
+static void _blit_tile(JiveTile *tile, JiveSurface *dst, Uint16 dx, Uint16 dy, Uint16 dw, Uint16 dh) {
+	Sint16 dst_offset_x, dst_offset_y;
+	SDL_Surface *dst_srf;
+	SDL_Surface *srf[9];
+	struct composed_tile *entry = NULL;
+
+	if (tile->flags & TILE_FLAG_BG) {
+		jive_surface_boxColor(dst, dx, dy, dx + dw - 1, dy + dh - 1, tile->bg);
+		return;
+	}
+
+	jive_surface_get_tile_blit(dst, &dst_srf, &dst_offset_x, &dst_offset_y);
+
+	dx += dst_offset_x;
+	dy += dst_offset_y;
+
+	if (tile->sdl) {
+		/* simple, data-loaded image */
+		blit_area(tile->sdl, dst_srf, dx, dy, dw, dh);
+		return;
+	}
+
+	/* drawn at this size before? */
+	if (tile->flags & TILE_FLAG_TILE) {
+		entry = _composed_find(tile, dw, dh);
+
+		if (entry && entry->sdl) {
+			SDL_Rect dr;
+
+			dr.x = dx;
+			dr.y = dy;
+			jive_blend_blit(entry->sdl, NULL, dst_srf, &dr);
+			return;
+		}
+	}
+
+	_get_tile_surfaces(tile, srf, true);
+	_init_tile_sizes(tile);
+
+	if ((tile->flags & TILE_FLAG_IMAGE) && srf[0]) {
+		/* dynamically-loaded image */
+		blit_area(srf[0], dst_srf, dx, dy, dw, dh);
+		return;
+	}
+
+	if (entry && (entry->sdl = _compose_tile(tile, srf, dw, dh))) {
+		struct composed_tile *prev, *e;
+		SDL_Rect dr;
+
+		entry->bytes = entry->sdl->pitch * entry->sdl->h;
+		composed_bytes += entry->bytes;
+
+		/* drop the oldest composed sizes, keeping this one */
+		for (e = composedTail; e && composed_bytes > COMPOSED_BUDGET; e = prev) {
+			prev = e->prev;
+
+			if (e != entry && e->sdl) {
+				_composed_drop(e);
+			}
+		}
+
+		dr.x = dx;
+		dr.y = dy;
+		jive_blend_blit(entry->sdl, NULL, dst_srf, &dr);
+		return;
 	}
+
+	_blit_pieces(tile, srf, dst_srf, dx, dy, dw, dh, blit_area);
 }
 
 
@@ -871,8 +1286,7 @@ JiveSurface *jive_surface_set_video_mode(Uint16 w, Uint16 h, Uint16 bpp, bool fu
 	return srf;
 }
 
-JiveSurface *jive_surface_newRGB(Uint16 w, Uint16 h) {
-	JiveSurface *srf;
+static SDL_Surface *_create_rgb(Uint16 w, Uint16 h) {
 	SDL_Surface *screen, *sdl;
 	int bpp;
 
@@ -884,16 +1298,11 @@ JiveSurface *jive_surface_newRGB(Uint16 w, Uint16 h) {
 	/* Opaque surface */
 	SDL_SetAlpha(sdl, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
 
-	srf = calloc(sizeof(JiveSurface), 1);
-	srf->refcount = 1;
-	srf->sdl = sdl;
-
-	return srf;
+	return sdl;
 }
 
 
-JiveSurface *jive_surface_newRGBA(Uint16 w, Uint16 h) {
-	JiveSurface *srf;
+static SDL_Surface *_create_rgba(Uint16 w, Uint16 h) {
 	SDL_Surface *sdl;
 
 	/*
@@ -911,70 +1320,487 @@ JiveSurface *jive_surface_newRGBA(Uint16 w, Uint16 h) {
 					   0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
 	}
 
-	/* alpha channel, paint transparency */
-	SDL_SetAlpha(sdl, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+	/* alpha channel, paint transparency */
+	SDL_SetAlpha(sdl, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+
+	return sdl;
+}
+
+
+JiveSurface *jive_surface_newRGB(Uint16 w, Uint16 h) {
+	JiveSurface *srf;
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = _create_rgb(w, h);
+
+	return srf;
+}
+
+
+JiveSurface *jive_surface_newRGBA(Uint16 w, Uint16 h) {
+	JiveSurface *srf;
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = _create_rgba(w, h);
+
+	return srf;
+}
+
+
+static void _pool_unlink(struct pooled_surface *entry) {
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	}
+	else {
+		poolHead = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	}
+	else {
+		poolTail = entry->prev;
+	}
+
+	pool_bytes -= entry->bytes;
+}
+
+
+/* free the oldest idle surfaces until within budget */
+static void _pool_trim(void) {
+	struct pooled_surface *entry;
+
+	while ((entry = poolTail) && pool_bytes > pool_budget) {
+		_pool_unlink(entry);
+		SDL_FreeSurface(entry->sdl);
+		free(entry);
+		pool_evictions++;
+	}
+}
+
+
+static void _pool_put(SDL_Surface *sdl) {
+	struct pooled_surface *entry;
+
+	pool_returns++;
+
+	entry = calloc(sizeof(struct pooled_surface), 1);
+	if (!entry) {
+		SDL_FreeSurface(sdl);
+		return;
+	}
+
+	entry->sdl = sdl;
+	entry->bytes = sdl->pitch * sdl->h;
+
+	entry->next = poolHead;
+	if (poolHead) {
+		poolHead->prev = entry;
+	}
+	else {
+		poolTail = entry;
+	}
+	poolHead = entry;
+	pool_bytes += entry->bytes;
+
+	_pool_trim();
+}
+
+
+/* drop the surface's pixels, pooled pixels no one else shares go back to the pool */
+static void _surface_put_sdl(JiveSurface *srf) {
+	if ((srf->flags & TILE_FLAG_POOLED) && srf->sdl->refcount == 1) {
+		_pool_put(srf->sdl);
+	}
+	else {
+		SDL_FreeSurface(srf->sdl);
+	}
+	srf->sdl = NULL;
+}
+
+
+/* a new surface sharing the pixels of sdl, as handed out by the caches */
+static JiveSurface *_surface_share(SDL_Surface *sdl) {
+	JiveSurface *srf;
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = sdl;
+	sdl->refcount++;
+
+	return srf;
+}
+
+
+/*
+ * As jive_surface_newRGB() or jive_surface_newRGBA(), reusing an idle
+ * surface of the same size and format if there is one. The surface is
+ * cleared, and goes back to the pool when freed or released.
+ */
+JiveSurface *jive_surface_acquire(Uint16 w, Uint16 h, bool alpha) {
+	struct pooled_surface *entry;
+	JiveSurface *srf;
+	SDL_Surface *sdl = NULL;
+	int bpp;
+
+	pool_acquires++;
+
+	bpp = alpha ? 32 : SDL_GetVideoSurface()->format->BitsPerPixel;
+
+	for (entry = poolHead; entry; entry = entry->next) {
+		SDL_Surface *s = entry->sdl;
+
+		if (s->w == w && s->h == h && s->format->BitsPerPixel == bpp && (s->format->Amask != 0) == alpha) {
+			_pool_unlink(entry);
+			sdl = s;
+			free(entry);
+			break;
+		}
+	}
+
+	if (sdl) {
+		pool_hits++;
+
+		/* as if newly created */
+		SDL_SetClipRect(sdl, NULL);
+		SDL_SetColorKey(sdl, 0, 0);
+		SDL_SetAlpha(sdl, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+		SDL_FillRect(sdl, NULL, 0);
+	}
+	else {
+		sdl = alpha ? _create_rgba(w, h) : _create_rgb(w, h);
+		if (!sdl) {
+			return NULL;
+		}
+	}
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = sdl;
+	srf->flags = TILE_FLAG_POOLED;
+
+	return srf;
+}
+
+
+void jive_surface_set_pool_budget(size_t bytes) {
+	pool_budget = bytes;
+	_pool_trim();
+}
+
+
+void jive_surface_get_pool_stats(size_t *bytes, size_t *budget, Uint32 *acquires, Uint32 *hits, Uint32 *returns, Uint32 *evictions) {
+	*bytes = pool_bytes;
+	*budget = pool_budget;
+	*acquires = pool_acquires;
+	*hits = pool_hits;
+	*returns = pool_returns;
+	*evictions = pool_evictions;
+}
+
+
+JiveSurface *jive_surface_new_SDLSurface(SDL_Surface *sdl_surface) {
+	JiveSurface *srf;
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = sdl_surface;
+
+	return srf;
+}
+
+
+JiveSurface *jive_surface_ref(JiveSurface *srf) {
+	return jive_tile_ref(srf);
+}
+
+
+bool jive_surface_is_opaque(JiveSurface *srf) {
+	return jive_tile_is_opaque(srf);
+}
+
+
+/*
+ * Convert image to best format for display on the screen
+ */
+static JiveSurface *jive_surface_display_format(JiveSurface *srf) {
+	SDL_Surface *sdl;
+
+	if (srf->sdl == NULL || SDL_GetVideoSurface() == NULL) {
+		return srf;
+	}
+
+	if (srf->sdl->format->Amask) {
+		sdl = SDL_DisplayFormatAlpha(srf->sdl);
+	}
+	else {
+		sdl = SDL_DisplayFormat(srf->sdl);
+	}
+	SDL_FreeSurface(srf->sdl);
+	srf->sdl = sdl;
+
+	return srf;
+}
+
+
+JiveSurface *jive_surface_load_image(const char *path) {
+	return jive_tile_load_image(path);
+}
+
+
+static Uint64 _hash_data(const char *data, size_t len) {
+	/* FNV-1a */
+	Uint64 hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= (Uint8) data[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+
+static void _decoded_unlink(struct decoded_image *entry) {
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	}
+	else {
+		decodedHead = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	}
+	else {
+		decodedTail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+}
+
+
+static void _decoded_push(struct decoded_image *entry) {
+	entry->prev = NULL;
+	entry->next = decodedHead;
+
+	if (decodedHead) {
+		decodedHead->prev = entry;
+	}
+	else {
+		decodedTail = entry;
+	}
+	decodedHead = entry;
+}
+
+
+/* drop the oldest surfaces no one else is using until within budget */
+static void _decoded_evict(void) {
+	struct decoded_image *entry, *prev;
+
+	for (entry = decodedTail; entry && decoded_bytes > decoded_budget; entry = prev) {
+		prev = entry->prev;
+
+		if (entry->srf->sdl->refcount > 1) {
+			continue;
+		}
+
+		_decoded_unlink(entry);
+		decoded_bytes -= entry->bytes;
+		decoded_entries--;
+		decoded_evictions++;
+
+		jive_surface_free(entry->srf);
+		free(entry);
+	}
+}
+
+
+static JiveSurface *_decoded_get(Uint64 hash, size_t len, Uint16 w, Uint16 h) {
+	struct decoded_image *entry;
+
+	for (entry = decodedHead; entry; entry = entry->next) {
+		if (entry->hash == hash && entry->len == len && entry->w == w && entry->h == h) {
+			_decoded_unlink(entry);
+			_decoded_push(entry);
+
+			decoded_hits++;
+			return _surface_share(entry->srf->sdl);
+		}
+	}
+
+	decoded_misses++;
+	return NULL;
+}
+
+
+static void _decoded_put(Uint64 hash, size_t len, Uint16 w, Uint16 h, JiveSurface *srf) {
+	struct decoded_image *entry;
+	int bytes = jive_surface_get_bytes(srf);
+
+	/* large images, such as photos, are not worth keeping */
+	if ((size_t) bytes > decoded_budget / 4) {
+		return;
+	}
+
+	entry = calloc(sizeof(struct decoded_image), 1);
+	entry->hash = hash;
+	entry->len = len;
+	entry->w = w;
+	entry->h = h;
+	entry->srf = _surface_share(srf->sdl);
+	entry->bytes = bytes;
+
+	_decoded_push(entry);
+	decoded_bytes += entry->bytes;
+	decoded_entries++;
+
+	_decoded_evict();
+}
+
+
+JiveSurface *jive_surface_load_image_data(const char *data, size_t len) {
+	Uint64 hash = _hash_data(data, len);
+	JiveSurface *srf;
+	SDL_RWops *src;
+	SDL_Surface *sdl;
+
+	srf = _decoded_get(hash, len, 0, 0);
+	if (srf) {
+		return srf;
+	}
+
+	src = SDL_RWFromConstMem(data, (int) len);
+	sdl = IMG_Load_RW(src, 1);
+
+	srf = calloc(sizeof(JiveSurface), 1);
+	srf->refcount = 1;
+	srf->sdl = sdl;
+
+	srf = jive_surface_display_format(srf);
+
+	if (srf->sdl) {
+		_decoded_put(hash, len, 0, 0, srf);
+	}
+
+	return srf;
+}
+
+
+/*
+ * Load an image from data resized to fit w, h keeping the aspect ratio,
+ * unless the image already has the width or the height. Large images
+ * are decoded at a reduced size before resampling.
+ */
+JiveSurface *jive_surface_load_image_data_sized(const char *data, size_t len, Uint16 w, Uint16 h) {
+	Uint64 hash = _hash_data(data, len);
+	JiveSurface *src, *srf;
+
+	srf = _decoded_get(hash, len, w, h);
+	if (srf) {
+		return srf;
+	}
+
+	src = jive_surface_load_image_data_scaled(data, len, w, h);
+	if (!src->sdl || src->sdl->w == w || src->sdl->h == h) {
+		return src;
+	}
 
-	srf = calloc(sizeof(JiveSurface), 1);
-	srf->refcount = 1;
-	srf->sdl = sdl;
+	srf = jive_surface_resize(src, w, h, true);
+	jive_surface_free(src);
+
+	if (srf) {
+		_decoded_put(hash, len, w, h, srf);
+	}
 
 	return srf;
 }
 
 
-JiveSurface *jive_surface_new_SDLSurface(SDL_Surface *sdl_surface) {
+/*
+ * Load an image from data at a reduced size that is still at least w, h
+ * if the image is larger than that. JPEGs and PNGs are reduced while
+ * decoding, see jive_image.c, other images are decoded in full. The
+ * result is not cached, these are expected to be large.
+ */
+JiveSurface *jive_surface_load_image_data_scaled(const char *data, size_t len, Uint16 w, Uint16 h) {
 	JiveSurface *srf;
+	SDL_Surface *sdl;
+
+	sdl = jive_image_decode_scaled(data, len, w, h);
+	if (!sdl) {
+		return jive_surface_load_image_data(data, len);
+	}
 
 	srf = calloc(sizeof(JiveSurface), 1);
 	srf->refcount = 1;
-	srf->sdl = sdl_surface;
+	srf->sdl = sdl;
 
-	return srf;
+	return jive_surface_display_format(srf);
 }
 
 
-JiveSurface *jive_surface_ref(JiveSurface *srf) {
-	return jive_tile_ref(srf);
-}
+JiveSurface *jive_surface_load_image_scaled(const char *path, Uint16 w, Uint16 h) {
+	JiveSurface *srf;
+	char *fullpath, *data;
+	FILE *fp;
+	long len;
 
+	if (!path) {
+		return NULL;
+	}
 
-/*
- * Convert image to best format for display on the screen
- */
-static JiveSurface *jive_surface_display_format(JiveSurface *srf) {
-	SDL_Surface *sdl;
+	fullpath = malloc(PATH_MAX);
 
-	if (srf->sdl == NULL || SDL_GetVideoSurface() == NULL) {
-		return srf;
+	if (!jive_find_file(path, fullpath)) {
+		LOG_ERROR(log_ui_draw, "Can't find image %s\n", path);
+		free(fullpath);
+		return NULL;
 	}
 
-	if (srf->sdl->format->Amask) {
-		sdl = SDL_DisplayFormatAlpha(srf->sdl);
+	fp = fopen(fullpath, "rb");
+	free(fullpath);
+	if (!fp) {
+		LOG_ERROR(log_ui_draw, "Can't open image %s\n", path);
+		return NULL;
 	}
-	else {
-		sdl = SDL_DisplayFormat(srf->sdl);
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = (len > 0) ? malloc(len) : NULL;
+	if (!data || fread(data, 1, len, fp) != (size_t) len) {
+		LOG_ERROR(log_ui_draw, "Can't read image %s\n", path);
+		fclose(fp);
+		free(data);
+		return NULL;
 	}
-	SDL_FreeSurface(srf->sdl);
-	srf->sdl = sdl;
+	fclose(fp);
+
+	srf = jive_surface_load_image_data_scaled(data, len, w, h);
+	free(data);
 
 	return srf;
 }
 
 
-JiveSurface *jive_surface_load_image(const char *path) {
-	return jive_tile_load_image(path);
+void jive_surface_set_cache_budget(size_t bytes) {
+	decoded_budget = bytes;
+	_decoded_evict();
 }
 
 
-JiveSurface *jive_surface_load_image_data(const char *data, size_t len) {
-	SDL_RWops *src = SDL_RWFromConstMem(data, (int) len);
-	SDL_Surface *sdl = IMG_Load_RW(src, 1);
-
-	JiveSurface *srf = calloc(sizeof(JiveSurface), 1);
-	srf->refcount = 1;
-	srf->sdl = sdl;
-
-	return jive_surface_display_format(srf);
+void jive_surface_get_cache_stats(size_t *bytes, size_t *budget, Uint32 *entries, Uint32 *hits, Uint32 *misses, Uint32 *evictions) {
+	*bytes = decoded_bytes;
+	*budget = decoded_budget;
+	*entries = decoded_entries;
+	*hits = decoded_hits;
+	*misses = decoded_misses;
+	*evictions = decoded_evictions;
 }
 
 
@@ -1178,7 +2004,7 @@ void jive_surface_blit(JiveSurface *src, JiveSurface *dst, Uint16 dx, Uint16 dy)
 	dr.x = dx + dst->offset_x;
 	dr.y = dy + dst->offset_y;
 
-	SDL_BlitSurface(_resolve_SDL_surface(src), 0, dst->sdl, &dr);
+	jive_blend_blit(_resolve_SDL_surface(src), 0, dst->sdl, &dr);
 
 #ifdef JIVE_PROFILE_BLIT
 	t1 = jive_jiffies();
@@ -1197,7 +2023,7 @@ void jive_surface_blit_clip(JiveSurface *src, Uint16 sx, Uint16 sy, Uint16 sw, U
 	sr.x = sx; sr.y = sy; sr.w = sw; sr.h = sh;
 	dr.x = dx + dst->offset_x; dr.y = dy + dst->offset_y;
 
-	SDL_BlitSurface(_resolve_SDL_surface(src), &sr, dst->sdl, &dr);
+	jive_blend_blit(_resolve_SDL_surface(src), &sr, dst->sdl, &dr);
 
 #ifdef JIVE_PROFILE_BLIT
 	t1 = jive_jiffies();
@@ -1211,12 +2037,18 @@ void jive_surface_blit_alpha(JiveSurface *src, JiveSurface *dst, Uint16 dx, Uint
 	Uint32 t0 = jive_jiffies(), t1;
 #endif //JIVE_PROFILE_BLIT
 
+	SDL_Surface *sdl = _resolve_SDL_surface(src);
+	Uint32 flags = sdl->flags & SDL_SRCALPHA;
+	Uint8 old_alpha = sdl->format->alpha;
 	SDL_Rect dr;
 	dr.x = dx + dst->offset_x;
 	dr.y = dy + dst->offset_y;
 
-	SDL_SetAlpha(_resolve_SDL_surface(src), SDL_SRCALPHA, alpha);
-	SDL_BlitSurface(_resolve_SDL_surface(src), 0, dst->sdl, &dr);
+	SDL_SetAlpha(sdl, SDL_SRCALPHA, alpha);
+	jive_blend_blit(sdl, 0, dst->sdl, &dr);
+
+	/* the pixels may be shared with cached surfaces */
+	SDL_SetAlpha(sdl, flags, old_alpha);
 
 #ifdef JIVE_PROFILE_BLIT
 	t1 = jive_jiffies();
@@ -1273,9 +2105,14 @@ void jive_surface_release(JiveSurface *srf) {
 		return;
 	}
 
+	/* sprites of these pixels go too */
+	if (spriteHead) {
+		_sprite_purge(srf);
+	}
+
+	/* pixels shared with a cache stay there until it drops them */
 	if (srf->sdl) {
-		SDL_FreeSurface (srf->sdl);
-		srf->sdl = NULL;
+		_surface_put_sdl(srf);
 	}
 }
 
@@ -1316,6 +2153,130 @@ JiveSurface *jive_surface_zoomSurface(JiveSurface *srf, double zoomx, double zoo
 	return srf2;
 }
 
+static void _sprite_unlink(struct sprite *entry) {
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	}
+	else {
+		spriteHead = entry->next;
+	}
+
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	}
+	else {
+		spriteTail = entry->prev;
+	}
+
+	entry->prev = entry->next = NULL;
+	sprite_bytes -= entry->bytes;
+}
+
+
+static void _sprite_push(struct sprite *entry) {
+	entry->prev = NULL;
+	entry->next = spriteHead;
+
+	if (spriteHead) {
+		spriteHead->prev = entry;
+	}
+	else {
+		spriteTail = entry;
+	}
+	spriteHead = entry;
+	sprite_bytes += entry->bytes;
+}
+
+
+/* drop the sprites of a surface being freed */
+static void _sprite_purge(JiveSurface *src) {
+	struct sprite *entry, *next, *purged = NULL;
+
+	/* unlink first, freeing a sprite may purge its own sprites */
+	for (entry = spriteHead; entry; entry = next) {
+		next = entry->next;
+
+		if (entry->src == src) {
+			_sprite_unlink(entry);
+			entry->next = purged;
+			purged = entry;
+		}
+	}
+
+	for (entry = purged; entry; entry = next) {
+		next = entry->next;
+
+		jive_surface_free(entry->srf);
+		free(entry);
+	}
+}
+
+
+/*
+ * Rotate and zoom a surface, or only zoom it if angle is 0, keeping the
+ * result for the next time. The surface returned shares the kept pixels
+ * and must not be drawn on.
+ */
+JiveSurface *jive_surface_rotozoom_cached(JiveSurface *srf, double angle, double zoomx, double zoomy, int smooth) {
+	struct sprite *entry, *prev;
+	Sint32 qangle, qzoomx, qzoomy;
+	JiveSurface *srf2;
+
+	qangle = (Sint32) floor(fmod(angle, 360.0) * SPRITE_ANGLE_STEPS + 0.5);
+	if (qangle < 0) {
+		qangle += 360 * SPRITE_ANGLE_STEPS;
+	}
+	qzoomx = (Sint32) floor(zoomx * SPRITE_ZOOM_STEPS + 0.5);
+	qzoomy = (Sint32) floor(zoomy * SPRITE_ZOOM_STEPS + 0.5);
+
+	for (entry = spriteHead; entry; entry = entry->next) {
+		if (entry->src == srf && entry->angle == qangle && entry->zoomx == qzoomx && entry->zoomy == qzoomy && entry->smooth == smooth) {
+			if (entry != spriteHead) {
+				_sprite_unlink(entry);
+				_sprite_push(entry);
+			}
+			return _surface_share(entry->srf->sdl);
+		}
+	}
+
+	if (qangle == 0) {
+		srf2 = jive_surface_zoomSurface(srf, (double) qzoomx / SPRITE_ZOOM_STEPS, (double) qzoomy / SPRITE_ZOOM_STEPS, smooth);
+	}
+	else {
+		srf2 = jive_surface_rotozoomSurface(srf, (double) qangle / SPRITE_ANGLE_STEPS, (double) qzoomx / SPRITE_ZOOM_STEPS, smooth);
+	}
+
+	if (!srf2 || !srf2->sdl) {
+		return srf2;
+	}
+
+	entry = calloc(sizeof(struct sprite), 1);
+	entry->src = srf;
+	entry->angle = qangle;
+	entry->zoomx = qzoomx;
+	entry->zoomy = qzoomy;
+	entry->smooth = smooth;
+	entry->srf = _surface_share(srf2->sdl);
+	entry->bytes = jive_surface_get_bytes(srf2);
+	_sprite_push(entry);
+
+	/* drop the oldest sprites no one is using */
+	for (entry = spriteTail; entry && sprite_bytes > SPRITE_BUDGET; entry = prev) {
+		prev = entry->prev;
+
+		if (entry->srf->sdl->refcount > 1) {
+			continue;
+		}
+
+		_sprite_unlink(entry);
+		jive_surface_free(entry->srf);
+		free(entry);
+	}
+
+	return srf2;
+}
+
+
 JiveSurface *jive_surface_shrinkSurface(JiveSurface *srf, int factorx, int factory) {
 	SDL_Surface *srf1_sdl;
 	JiveSurface *srf2;
@@ -1684,11 +2645,98 @@ int jiveL_surface_load_image_data(lua_State *L) {
 	  class
 	  image
 	  len
+	  w (optional)
+	  h (optional)
+	*/
+	const char *image = luaL_checklstring(L, 2, NULL);
+	int len = luaL_checkint(L, 3);
+	int w = luaL_optinteger(L, 4, 0);
+	int h = luaL_optinteger(L, 5, w);
+	if (image && len) {
+		JiveSurface *srf;
+
+		if (w > 0 && h > 0) {
+			srf = jive_surface_load_image_data_sized(image, len, w, h);
+		}
+		else {
+			srf = jive_surface_load_image_data(image, len);
+		}
+
+		if (srf) {
+			JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
+			*p = srf;
+			luaL_getmetatable(L, "JiveSurface");
+			lua_setmetatable(L, -2);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int jiveL_surface_load_image_scaled(lua_State *L) {
+	/*
+	  class
+	  imagepath
+	  w
+	  h
+	*/
+	const char *imagepath = luaL_checklstring(L, 2, NULL);
+	int w = luaL_checkint(L, 3);
+	int h = luaL_checkint(L, 4);
+	if (imagepath) {
+		JiveSurface *srf = jive_surface_load_image_scaled(imagepath, w, h);
+		if (srf) {
+			JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
+			*p = srf;
+			luaL_getmetatable(L, "JiveSurface");
+			lua_setmetatable(L, -2);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int jiveL_surface_load_image_data_scaled(lua_State *L) {
+	/*
+	  class
+	  image
+	  len
+	  w
+	  h
 	*/
 	const char *image = luaL_checklstring(L, 2, NULL);
 	int len = luaL_checkint(L, 3);
+	int w = luaL_checkint(L, 4);
+	int h = luaL_checkint(L, 5);
 	if (image && len) {
-		JiveSurface *srf = jive_surface_load_image_data(image, len);
+		JiveSurface *srf = jive_surface_load_image_data_scaled(image, len, w, h);
+		if (srf) {
+			JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
+			*p = srf;
+			luaL_getmetatable(L, "JiveSurface");
+			lua_setmetatable(L, -2);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int jiveL_surface_acquire(lua_State *L) {
+	/*
+	  class
+	  width
+	  height
+	  alpha
+	*/
+	int width = luaL_checkint(L, 2);
+	int height= luaL_checkint(L, 3);
+	bool alpha = lua_toboolean(L, 4);
+
+	if (width && height) {
+		JiveSurface *srf = jive_surface_acquire(width, height, alpha);
 		if (srf) {
 			JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
 			*p = srf;
@@ -1701,6 +2749,70 @@ int jiveL_surface_load_image_data(lua_State *L) {
 	return 0;
 }
 
+int jiveL_surface_set_pool_budget(lua_State *L) {
+	/*
+	  class
+	  bytes
+	*/
+	jive_surface_set_pool_budget(luaL_checkinteger(L, 2));
+	return 0;
+}
+
+int jiveL_surface_get_pool_stats(lua_State *L) {
+	size_t bytes, budget;
+	Uint32 acquires, hits, returns, evictions;
+
+	jive_surface_get_pool_stats(&bytes, &budget, &acquires, &hits, &returns, &evictions);
+
+	lua_newtable(L);
+	lua_pushinteger(L, bytes);
+	lua_setfield(L, -2, "bytes");
+	lua_pushinteger(L, budget);
+	lua_setfield(L, -2, "budget");
+	lua_pushinteger(L, acquires);
+	lua_setfield(L, -2, "acquires");
+	lua_pushinteger(L, hits);
+	lua_setfield(L, -2, "hits");
+	lua_pushinteger(L, returns);
+	lua_setfield(L, -2, "returns");
+	lua_pushinteger(L, evictions);
+	lua_setfield(L, -2, "evictions");
+
+	return 1;
+}
+
+int jiveL_surface_set_cache_budget(lua_State *L) {
+	/*
+	  class
+	  bytes
+	*/
+	jive_surface_set_cache_budget(luaL_checkinteger(L, 2));
+	return 0;
+}
+
+int jiveL_surface_get_cache_stats(lua_State *L) {
+	size_t bytes, budget;
+	Uint32 entries, hits, misses, evictions;
+
+	jive_surface_get_cache_stats(&bytes, &budget, &entries, &hits, &misses, &evictions);
+
+	lua_newtable(L);
+	lua_pushinteger(L, entries);
+	lua_setfield(L, -2, "entries");
+	lua_pushinteger(L, bytes);
+	lua_setfield(L, -2, "bytes");
+	lua_pushinteger(L, budget);
+	lua_setfield(L, -2, "budget");
+	lua_pushinteger(L, hits);
+	lua_setfield(L, -2, "hits");
+	lua_pushinteger(L, misses);
+	lua_setfield(L, -2, "misses");
+	lua_pushinteger(L, evictions);
+	lua_setfield(L, -2, "evictions");
+
+	return 1;
+}
+
 int jiveL_surface_draw_text(lua_State *L) {
 	/*
 	  class
@@ -1958,6 +3070,54 @@ int jiveL_surface_zoomSurface(lua_State *L) {
 	return 0;
 }
 
+int jiveL_surface_rotozoom_cached(lua_State *L) {
+	/*
+	  surface
+	  angle
+	  zoom
+	  smooth
+	*/
+	JiveSurface *srf1 = *(JiveSurface **)lua_touserdata(L, 1);
+	double angle = luaL_checknumber(L, 2);
+	double zoom  = luaL_checknumber(L, 3);
+	int smooth = lua_isnumber(L, 4) ? luaL_checkint(L, 4) : 1;
+
+	JiveSurface *srf2 = jive_surface_rotozoom_cached(srf1, angle, zoom, zoom, smooth);
+	if (srf2) {
+		JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
+		*p = srf2;
+		luaL_getmetatable(L, "JiveSurface");
+		lua_setmetatable(L, -2);
+		return 1;
+	}
+
+	return 0;
+}
+
+int jiveL_surface_zoom_cached(lua_State *L) {
+	/*
+	  surface
+	  zoomx
+	  zoomy
+	  smooth
+	*/
+	JiveSurface *srf1 = *(JiveSurface **)lua_touserdata(L, 1);
+	double zoomx = luaL_checknumber(L, 2);
+	double zoomy  = luaL_checknumber(L, 3);
+	int smooth = lua_isnumber(L, 4) ? luaL_checkint(L, 4) : 1;
+
+	JiveSurface *srf2 = jive_surface_rotozoom_cached(srf1, 0, zoomx, zoomy, smooth);
+	if (srf2) {
+		JiveSurface **p = (JiveSurface **)lua_newuserdata(L, sizeof(JiveSurface *));
+		*p = srf2;
+		luaL_getmetatable(L, "JiveSurface");
+		lua_setmetatable(L, -2);
+		return 1;
+	}
+
+	return 0;
+}
+
 int jiveL_surface_shrinkSurface(lua_State *L) {
 	/*
 	  surface
@@ -0,0 +1,199 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "common.h"
+#include "jive.h"
+
+
+/*
+ * Per-frame telemetry. The framework fills in jive_frame while a frame
+ * is being processed, and the main loop commits it into a fixed size
+ * ring buffer once the frame is complete. The ring is always on, the
+ * cost is a handful of clock reads and one struct copy per frame.
+ */
+
+/* must be a power of two */
+#define TELEMETRY_FRAMES 1024
+
+#define TELEMETRY_MAGIC "JFTS"
+#define TELEMETRY_VERSION 1
+
+struct jive_frame_stats jive_frame;
+
+static struct jive_frame_stats ring[TELEMETRY_FRAMES];
+static Uint32 ring_head = 0;	/* total frames committed */
+
+
+void jive_telemetry_commit(Uint16 tasks) {
+	jive_frame.tasks = tasks;
+
+	memcpy(&ring[ring_head & (TELEMETRY_FRAMES - 1)], &jive_frame, sizeof(jive_frame));
+	ring_head++;
+
+	memset(&jive_frame, 0, sizeof(jive_frame));
+}
+
+
+static Uint32 telemetry_count(void) {
+	return MIN(ring_head, TELEMETRY_FRAMES);
+}
+
+
+static struct jive_frame_stats *telemetry_get(Uint32 i) {
+	/* i = 0 is the oldest frame held in the ring */
+	return &ring[(ring_head - telemetry_count() + i) & (TELEMETRY_FRAMES - 1)];
+}
+
+
+int jiveL_gc_step(lua_State *L) {
+	Uint32 t0;
+
+	/* stack is:
+	 * 1: framework
+	 */
+
+	t0 = jive_usecs();
+	lua_gc(L, LUA_GCSTEP, 0);
+	jive_frame.gc += jive_usecs() - t0;
+
+	return 0;
+}
+
+
+int jiveL_commit_frame_stats(lua_State *L) {
+	/* stack is:
+	 * 1: framework
+	 * 2: number of tasks resumed during the frame
+	 */
+
+	jive_telemetry_commit(luaL_optinteger(L, 2, 0));
+
+	return 0;
+}
+
+
+int jiveL_get_frame_stats(lua_State *L) {
+	Uint32 i, n, count;
+
+	/* stack is:
+	 * 1: framework
+	 * 2: number of frames (optional, defaults to all)
+	 */
+
+	count = telemetry_count();
+	n = luaL_optinteger(L, 2, count);
+	if (n > count) {
+		n = count;
+	}
+
+	lua_createtable(L, n, 0);
+	for (i = 0; i < n; i++) {
+		struct jive_frame_stats *s = telemetry_get(count - n + i);
+
+		lua_createtable(L, 0, 11);
+
+		lua_pushinteger(L, s->ticks);
+		lua_setfield(L, -2, "ticks");
+		lua_pushinteger(L, s->layout);
+		lua_setfield(L, -2, "layout");
+		lua_pushinteger(L, s->animate);
+		lua_setfield(L, -2, "animate");
+		lua_pushinteger(L, s->background);
+		lua_setfield(L, -2, "background");
+		lua_pushinteger(L, s->draw);
+		lua_setfield(L, -2, "draw");
+		lua_pushinteger(L, s->flip);
+		lua_setfield(L, -2, "flip");
+		lua_pushinteger(L, s->gc);
+		lua_setfield(L, -2, "gc");
+		lua_pushinteger(L, s->dirty);
+		lua_setfield(L, -2, "dirty");
+		lua_pushinteger(L, s->pixels);
+		lua_setfield(L, -2, "pixels");
+		lua_pushinteger(L, s->events);
+		lua_setfield(L, -2, "events");
+		lua_pushinteger(L, s->tasks);
+		lua_setfield(L, -2, "tasks");
+
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
+
+int jiveL_reset_frame_stats(lua_State *L) {
+	ring_head = 0;
+	memset(&jive_frame, 0, sizeof(jive_frame));
+
+	return 0;
+}
+
+
+/*
+ * Binary dumps are a header (magic, version, record size, record count
+ * as native endian Uint32) followed by the records, oldest first.
+ */
+int jiveL_dump_frame_stats(lua_State *L) {
+	const char *path, *format;
+	FILE *fp;
+	Uint32 i, count;
+	bool binary;
+
+	/* stack is:
+	 * 1: framework
+	 * 2: file path
+	 * 3: format, "csv" (default) or "bin"
+	 */
+
+	path = luaL_checkstring(L, 2);
+	format = luaL_optstring(L, 3, "csv");
+	binary = (strcmp(format, "bin") == 0);
+
+	fp = fopen(path, binary ? "wb" : "w");
+	if (!fp) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", path, strerror(errno));
+		return 2;
+	}
+
+	count = telemetry_count();
+
+	if (binary) {
+		Uint32 header[3];
+
+		header[0] = TELEMETRY_VERSION;
+		header[1] = sizeof(struct jive_frame_stats);
+		header[2] = count;
+
+		fwrite(TELEMETRY_MAGIC, 4, 1, fp);
+		fwrite(header, sizeof(header), 1, fp);
+
+		for (i = 0; i < count; i++) {
+			fwrite(telemetry_get(i), sizeof(struct jive_frame_stats), 1, fp);
+		}
+	}
+	else {
+		fprintf(fp, "ticks,layout,animate,background,draw,flip,gc,dirty,pixels,events,tasks\n");
+
+		for (i = 0; i < count; i++) {
+			struct jive_frame_stats *s = telemetry_get(i);
+
+			fprintf(fp, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+				s->ticks, s->layout, s->animate, s->background, s->draw,
+				s->flip, s->gc, s->dirty, s->pixels, s->events, s->tasks);
+		}
+	}
+
+	if (fclose(fp) != 0) {
+		lua_pushnil(L);
+		lua_pushfstring(L, "%s: %s", path, strerror(errno));
+		return 2;
+	}
+
+	lua_pushinteger(L, count);
+	return 1;
+}
@@ -8,6 +8,16 @@
 #include "jive.h"
 
 
+/* rendered lines are kept in a ring around the visible lines, this many
+ * pages of lines are kept above and below */
+#define LINE_CACHE_PAGES 1
+
+typedef struct textarea_line {
+	int index;				/* line number, or -1 if the slot is empty */
+	JiveSurface *srf;			/* text with its shadow, NULL for an empty line */
+	Uint16 width;				/* text width, without the shadow */
+} TextareaLine;
+
 typedef struct textarea_widget {
 	JiveWidget w;
 
@@ -19,6 +29,10 @@ typedef struct textarea_widget {
 	bool hide_scrollbar;
 	bool is_header_widget;
 
+	// rendered lines, slot is line number modulo cache_size
+	TextareaLine *cache;
+	int cache_size;
+
 	// style
 	JiveFont *font;
 	Uint16 line_height;
@@ -40,9 +54,25 @@ static JivePeerMeta textareaPeerMeta = {
 
 
 static void invalidate(TextareaWidget *peer);
+static void flush_lines(TextareaWidget *peer);
+static void set_lines(TextareaWidget *peer, int *lines, int num_lines);
 static void wordwrap(TextareaWidget *peer, char *text, int visible_lines, Uint16 sw, bool has_scrollbar);
 
 
+static void opaque_bounds(JiveWidget *w, SDL_Rect *r) {
+	TextareaWidget *peer = (TextareaWidget *) w;
+
+	/* nothing is drawn, not even the background, without any lines */
+	if (peer->num_lines == 0) {
+		r->w = 0;
+		r->h = 0;
+		return;
+	}
+
+	jive_widget_opaque_tile(w, peer->bg_tile, r);
+}
+
+
 int jiveL_textarea_skin(lua_State *L) {
 	TextareaWidget *peer;
 	JiveTile *bg_tile;
@@ -58,6 +88,7 @@ int jiveL_textarea_skin(lua_State *L) {
 	peer = jive_getpeer(L, 1, &textareaPeerMeta);
 
 	jive_widget_pack(L, 1, (JiveWidget *)peer);
+	peer->w.opaque = opaque_bounds;
 
 
 	peer->font = jive_font_ref(jive_style_font(L, 1, "font"));
@@ -247,6 +278,20 @@ int jiveL_textarea_layout(lua_State *L) {
 	visible_lines = peer->w.bounds.h / peer->line_height;
 	wordwrap(peer, (char *) text, visible_lines, sw, false);
 
+	/* size the rendered line ring for the visible lines */
+	if (peer->cache_size != (visible_lines + 1) * (1 + 2 * LINE_CACHE_PAGES)) {
+		int i;
+
+		flush_lines(peer);
+
+		peer->cache_size = (visible_lines + 1) * (1 + 2 * LINE_CACHE_PAGES);
+		peer->cache = realloc(peer->cache, sizeof(TextareaLine) * peer->cache_size);
+		for (i = 0; i < peer->cache_size; i++) {
+			peer->cache[i].index = -1;
+			peer->cache[i].srf = NULL;
+		}
+	}
+
 	lua_pushinteger(L, peer->num_lines);
 	lua_setfield(L, 1, "numLines");
 
@@ -440,53 +485,65 @@ int jiveL_textarea_draw(lua_State *L) {
 
 	bottom_line = top_line + visible_lines;
 
-	for (i = top_line; i < bottom_line + 1 && i < num_lines ; i++) {
-		JiveSurface *tsrf;
+	for (i = top_line; i < bottom_line + 1 && i < num_lines && i < peer->num_lines; i++) {
+		TextareaLine *cached;
 		int x;
 
-		int line = peer->lines[i];
-		int next = peer->lines[i+1];
+		if (!peer->cache_size) {
+			break;
+		}
+
+		/* render the line, unless we have it from a previous draw */
+		cached = &peer->cache[i % peer->cache_size];
+		if (cached->index != i) {
+			int line = peer->lines[i];
+			int next = peer->lines[i+1];
+
+			unsigned char b = text[(next - 1)];
+			unsigned char c = text[next];
+			text[next] = '\0';
+			if (b == '\n') {
+				text[(next - 1)] = '\0';
+			}
+
+			if (cached->srf) {
+				jive_surface_free(cached->srf);
+				cached->srf = NULL;
+			}
+			cached->index = i;
+			cached->width = 0;
+
+			/* to suppress 'get_image_surface - no SDL surface available' error we
+			   only draw if there's something to draw */
+			if (text[line] != '\0') {
+				if (peer->is_sh) {
+					cached->srf = jive_font_draw_text_shadow(peer->font, peer->fg, peer->sh, &text[line]);
+				}
+				else {
+					cached->srf = jive_font_draw_text(peer->font, peer->fg, &text[line]);
+				}
+				cached->width = jive_font_width(peer->font, &text[line]);
+			}
 
-		unsigned char b = text[(next - 1)];
-		unsigned char c = text[next];
-		text[next] = '\0';
-		if (b == '\n') {
-			text[(next - 1)] = '\0';
+			text[next] = c;
+			text[(next - 1)] = b;
 		}
 
 		x = peer->w.bounds.x + peer->w.padding.left;
 		switch (peer->align) {
 		case JIVE_ALIGN_CENTER:
 		case JIVE_ALIGN_TOP:
-		case JIVE_ALIGN_BOTTOM: {
-			Uint16 line_width = jive_font_width(peer->font, &text[line]);
-			x = jive_widget_halign((JiveWidget *)peer, peer->align, line_width);
+		case JIVE_ALIGN_BOTTOM:
+			x = jive_widget_halign((JiveWidget *)peer, peer->align, cached->width);
 			break;
-		}
 		default:
 			break;
 		}
 
-		/* to suppress 'get_image_surface - no SDL surface available' error we
-		   only draw if there's something to draw */
-		if (text[line] != '\0') {
-
-			/* shadow text */
-			if (peer->is_sh) {
-				tsrf = jive_font_draw_text(peer->font, peer->sh, &text[line]);
-				jive_surface_blit(tsrf, srf, x + 1, y + 1);
-				jive_surface_free(tsrf);
-			}
-
-			/* foreground text */
-			tsrf = jive_font_draw_text(peer->font, peer->fg, &text[line]);
-			jive_surface_blit(tsrf, srf, x, y);
-			jive_surface_free(tsrf);
+		if (cached->srf) {
+			jive_surface_blit(cached->srf, srf, x, y);
 		}
 
-		text[next] = c;
-		text[(next - 1)] = b;
-
 		y += peer->line_height;
 	}
 	if (!is_menu_child) {
@@ -517,6 +574,38 @@ static void invalidate(TextareaWidget *peer)
 		peer->num_lines = 0;
 		peer->lines = NULL;
 	}
+
+	flush_lines(peer);
+}
+
+
+static void flush_lines(TextareaWidget *peer)
+{
+	int i;
+
+	for (i = 0; i < peer->cache_size; i++) {
+		if (peer->cache[i].srf) {
+			jive_surface_free(peer->cache[i].srf);
+			peer->cache[i].srf = NULL;
+		}
+		peer->cache[i].index = -1;
+	}
+}
+
+
+/* replace the line breaks, dropping rendered lines if they moved */
+static void set_lines(TextareaWidget *peer, int *lines, int num_lines)
+{
+	if (!peer->lines || peer->num_lines != num_lines ||
+	    memcmp(peer->lines, lines, sizeof(int) * (num_lines + 1)) != 0) {
+		flush_lines(peer);
+	}
+
+	if (peer->lines) {
+		free(peer->lines);
+	}
+	peer->num_lines = num_lines;
+	peer->lines = realloc(lines, sizeof(int) * (num_lines + 1));
 }
 
 
@@ -539,12 +628,7 @@ static void wordwrap(TextareaWidget *peer, char *text, int visible_lines, Uint16
 		lines[0] = 0;
 		lines[1] = strlen(ptr);
 
-		if (peer->lines) {
-			free(peer->lines);
-		}
-
-		peer->num_lines = 1;
-		peer->lines = realloc(lines, sizeof(int) * (1 + 1));
+		set_lines(peer, (int *) lines, 1);
 
 		return;
 	}
@@ -645,11 +729,7 @@ static void wordwrap(TextareaWidget *peer, char *text, int visible_lines, Uint16
 		return wordwrap(peer, text, visible_lines, scrollbar_width, true);
 	}
 
-	if (peer->lines) {
-		free(peer->lines);
-	}
-	peer->num_lines = num_lines;
-	peer->lines = realloc(lines, sizeof(int) * (num_lines + 1));
+	set_lines(peer, (int *) lines, num_lines);
 }
 
 
@@ -664,6 +744,12 @@ int jiveL_textarea_gc(lua_State *L) {
 		free(peer->lines);
 		peer->lines = NULL;
 	}
+	if (peer->cache) {
+		flush_lines(peer);
+		free(peer->cache);
+		peer->cache = NULL;
+		peer->cache_size = 0;
+	}
 	if (peer->font) {
 		jive_font_free(peer->font);
 		peer->font = NULL;
@@ -8,9 +8,30 @@
 #include "jive.h"
 
 
+/* text segments either side of and under the cursor */
+enum {
+	SEGMENT_PRE,
+	SEGMENT_CURSOR,
+	SEGMENT_POST,
+	NUM_SEGMENTS,
+};
+
+/* a measured segment, and its text rendered with the shadow when drawn */
+typedef struct textinput_segment {
+	char *text;
+	size_t len;
+	Uint16 width;
+	JiveSurface *srf;
+} TextinputSegment;
+
 typedef struct textinput_widget {
 	JiveWidget w;
 
+	// cached text segments and wheel characters
+	TextinputSegment segment[NUM_SEGMENTS];
+	JiveSurface *wheel_char[256];
+	Uint16 wheel_char_w[256];
+
 	// skin properties
 	JiveFont *font;
 	JiveFont *cursor_font;
@@ -39,6 +60,83 @@ static JivePeerMeta textinputPeerMeta = {
 };
 
 
+static void flush_segments(TextinputWidget *peer) {
+	int i;
+
+	for (i = 0; i < NUM_SEGMENTS; i++) {
+		TextinputSegment *seg = &peer->segment[i];
+
+		if (seg->srf) {
+			jive_surface_free(seg->srf);
+			seg->srf = NULL;
+		}
+		if (seg->text) {
+			free(seg->text);
+			seg->text = NULL;
+		}
+		seg->len = 0;
+		seg->width = 0;
+	}
+
+	for (i = 0; i < 256; i++) {
+		if (peer->wheel_char[i]) {
+			jive_surface_free(peer->wheel_char[i]);
+			peer->wheel_char[i] = NULL;
+		}
+	}
+}
+
+
+/* measure a segment, only if its text has changed since the last time */
+static Uint16 segment_width(TextinputSegment *seg, JiveFont *font, const char *str, size_t len) {
+	if (seg->text && seg->len == len && memcmp(seg->text, str, len) == 0) {
+		return seg->width;
+	}
+
+	if (seg->srf) {
+		jive_surface_free(seg->srf);
+		seg->srf = NULL;
+	}
+
+	seg->text = realloc(seg->text, len + 1);
+	memcpy(seg->text, str, len);
+	seg->text[len] = '\0';
+	seg->len = len;
+	seg->width = len ? jive_font_nwidth(font, str, len) : 0;
+
+	return seg->width;
+}
+
+
+/* the measured segment text, rendered on first use */
+static JiveSurface *segment_surface(TextinputWidget *peer, TextinputSegment *seg, JiveFont *font, Uint32 fg) {
+	if (!seg->srf) {
+		if (peer->is_sh) {
+			seg->srf = jive_font_draw_text_shadow(font, fg, peer->sh, seg->text);
+		}
+		else {
+			seg->srf = jive_font_draw_text(font, fg, seg->text);
+		}
+	}
+
+	return seg->srf;
+}
+
+
+/* a wheel character, rendered on first use */
+static JiveSurface *wheel_char(TextinputWidget *peer, const char *ptr, Uint16 *w) {
+	unsigned char c = (unsigned char) *ptr;
+
+	if (!peer->wheel_char[c]) {
+		peer->wheel_char[c] = jive_font_ndraw_text(peer->wheel_font, peer->wh, ptr, 1);
+		peer->wheel_char_w[c] = jive_font_nwidth(peer->wheel_font, ptr, 1);
+	}
+
+	*w = peer->wheel_char_w[c];
+	return peer->wheel_char[c];
+}
+
+
 
 int jiveL_textinput_skin(lua_State *L) {
 	TextinputWidget *peer;
@@ -109,6 +207,9 @@ int jiveL_textinput_skin(lua_State *L) {
 	peer->char_offset_y = jive_style_int(L, 1, "charOffsetY", 0);
 	peer->wheel_char_offset_y = jive_style_int(L, 1, "wheelCharOffsetY", 0);
 
+	/* fonts or colors may have changed */
+	flush_segments(peer);
+
 	return 0;
 }
 
@@ -195,10 +296,10 @@ int jiveL_textinput_draw(lua_State *L) {
 //		cursor_h = 54;
 	}
 
-	/* measure text */
-	len_1 = jive_font_nwidth(peer->font, text, cursor - cursor_width);
-	len_2 = jive_font_nwidth(peer->cursor_font, text + cursor - cursor_width, cursor_width);
-	len_3 = (cursor < text_len) ? jive_font_width(peer->font, text + cursor) : 0;
+	/* measure text, the segments are only measured again when they change */
+	len_1 = segment_width(&peer->segment[SEGMENT_PRE], peer->font, text, cursor - cursor_width);
+	len_2 = segment_width(&peer->segment[SEGMENT_CURSOR], peer->cursor_font, text + cursor - cursor_width, cursor_width);
+	len_3 = (cursor < text_len) ? segment_width(&peer->segment[SEGMENT_POST], peer->font, text + cursor, text_len - cursor) : 0;
 
 	if (cursor_w < len_2) {
 		cursor_w = len_2;
@@ -211,9 +312,9 @@ int jiveL_textinput_draw(lua_State *L) {
 		text_len--;
 		cursor--;
 
-		len_1 = jive_font_nwidth(peer->font, text, cursor - cursor_width);
-		len_2 = jive_font_nwidth(peer->cursor_font, text + cursor - cursor_width, cursor_width);
-		len_3 = (cursor < text_len) ? jive_font_width(peer->font, text + cursor) : 0;
+		len_1 = segment_width(&peer->segment[SEGMENT_PRE], peer->font, text, cursor - cursor_width);
+		len_2 = segment_width(&peer->segment[SEGMENT_CURSOR], peer->cursor_font, text + cursor - cursor_width, cursor_width);
+		len_3 = (cursor < text_len) ? segment_width(&peer->segment[SEGMENT_POST], peer->font, text + cursor, text_len - cursor) : 0;
 	}
 
 	/* move ident if cursor is off stage left and fill out space if indent present*/
@@ -224,9 +325,9 @@ int jiveL_textinput_draw(lua_State *L) {
 		text_len++;
 		cursor++;
 
-		len_1 = jive_font_nwidth(peer->font, text, cursor - cursor_width);
-		len_2 = jive_font_nwidth(peer->cursor_font, text + cursor - cursor_width, cursor_width);
-		len_3 = (cursor < text_len) ? jive_font_width(peer->font, text + cursor) : 0;
+		len_1 = segment_width(&peer->segment[SEGMENT_PRE], peer->font, text, cursor - cursor_width);
+		len_2 = segment_width(&peer->segment[SEGMENT_CURSOR], peer->cursor_font, text + cursor - cursor_width, cursor_width);
+		len_3 = (cursor < text_len) ? segment_width(&peer->segment[SEGMENT_POST], peer->font, text + cursor, text_len - cursor) : 0;
 	}
 
 	/* keep cursor fixed distance from stage right */
@@ -306,53 +407,26 @@ int jiveL_textinput_draw(lua_State *L) {
 
 	/* draw text label */
 	if (drawLayer && peer->font) {
-	  
-		if (peer->is_sh) {
-			/* pre-cursor */
-			/* to suppress 'get_image_surface - no SDL surface available' error we only draw if there's something to draw */
-			if (len_1 > 0) {
-				tsrf = jive_font_ndraw_text(peer->font, peer->sh, text, cursor - cursor_width);
-				jive_surface_blit(tsrf, srf, text_x + 1, text_y + offset_y + 1);
-				jive_surface_free(tsrf);
-			}
-
-			/* cursor */
-			/* something to draw ? */
-			if (len_2 > 0) {
-				tsrf = jive_font_ndraw_text(peer->cursor_font, peer->sh, text + cursor - cursor_width, cursor_width);
-				jive_surface_blit(tsrf, srf, cursor_x + (cursor_w - len_2) / 2 + 1, text_y + offset_cursor_y + 1);
-				jive_surface_free(tsrf);
-			}
-
-			/* post-cursor */
-			if (cursor < text_len) {
-				tsrf = jive_font_draw_text(peer->font, peer->sh, text + cursor);
-				jive_surface_blit(tsrf, srf, cursor_x + cursor_w + 1, text_y + offset_y + 1);
-				jive_surface_free(tsrf);
-			}
-		}
+		/* segments are drawn with their shadow, from the last measure */
 
 		/* pre-cursor */
-		/* something to draw ? */
+		/* to suppress 'get_image_surface - no SDL surface available' error we only draw if there's something to draw */
 		if (len_1 > 0) {
-			tsrf = jive_font_ndraw_text(peer->font, peer->fg, text, cursor - cursor_width);
+			tsrf = segment_surface(peer, &peer->segment[SEGMENT_PRE], peer->font, peer->fg);
 			jive_surface_blit(tsrf, srf, text_x, text_y + offset_y);
-			jive_surface_free(tsrf);
 		}
 
 		/* cursor */
 		/* something to draw ? */
 		if (len_2 > 0) {
-			tsrf = jive_font_ndraw_text(peer->cursor_font, peer->cursor_color, text + cursor - cursor_width, cursor_width);
+			tsrf = segment_surface(peer, &peer->segment[SEGMENT_CURSOR], peer->cursor_font, peer->cursor_color);
 			jive_surface_blit(tsrf, srf, cursor_x + (cursor_w - len_2) / 2, text_y + offset_cursor_y);
-			jive_surface_free(tsrf);
 		}
 
 		/* post-cursor */
 		if (cursor < text_len) {
-			tsrf = jive_font_draw_text(peer->font, peer->fg, text + cursor);
+			tsrf = segment_surface(peer, &peer->segment[SEGMENT_POST], peer->font, peer->fg);
 			jive_surface_blit(tsrf, srf, cursor_x + cursor_w, text_y + offset_y);
-			jive_surface_free(tsrf);
 		}
 
 		if ((cursor > text_len || cursor == 0) && peer->enter_tile) {
@@ -374,6 +448,7 @@ int jiveL_textinput_draw(lua_State *L) {
 
 	if (drawLayer) {
 		const char *ptr_up, *ptr_down, *ptr;
+		Uint16 char_w;
 
 		if (cursor > 1 && cursor > text_len) {
 			/* new char, keep cursor near the last letter */
@@ -395,11 +470,10 @@ int jiveL_textinput_draw(lua_State *L) {
 				ptr = validchars;
 			}
 
-			offset_x = (cursor_w - jive_font_nwidth(peer->wheel_font, ptr, 1)) / 2;
-			
-			tsrf = jive_font_ndraw_text(peer->wheel_font, peer->wh, ptr, 1);
+			tsrf = wheel_char(peer, ptr, &char_w);
+			offset_x = (cursor_w - char_w) / 2;
+
 			jive_surface_blit(tsrf, srf, cursor_x + offset_x, text_cy - (cursor_h / 2) + (-i * peer->wheel_char_height) + jive_font_miny_char(peer->wheel_font, ptr[0]) - peer->wheel_char_offset_y);
-			jive_surface_free(tsrf);
 
 			ptr--; // FIXME utf8
 		}
@@ -414,11 +488,10 @@ int jiveL_textinput_draw(lua_State *L) {
 				ptr = validchars;
 			}
 
-			offset_x = (cursor_w - jive_font_nwidth(peer->wheel_font, ptr, 1)) / 2;
-			
-			tsrf = jive_font_ndraw_text(peer->wheel_font, peer->wh, ptr, 1);
+			tsrf = wheel_char(peer, ptr, &char_w);
+			offset_x = (cursor_w - char_w) / 2;
+
 			jive_surface_blit(tsrf, srf, cursor_x + offset_x, text_cy + (cursor_h / 2) + ((i - 1) * peer->wheel_char_height) );
-			jive_surface_free(tsrf);
 
 			ptr++; // FIXME utf8
 		}
@@ -473,6 +546,8 @@ int jiveL_textinput_gc(lua_State *L) {
 
 	peer = lua_touserdata(L, 1);
 
+	flush_segments(peer);
+
 	if (peer->font) {
 		jive_font_free(peer->font);
 		peer->font = NULL;
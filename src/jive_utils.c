@@ -189,3 +189,11 @@ void jive_rect_intersection(SDL_Rect *a, SDL_Rect *b, SDL_Rect *c) {
 		c->h = cy1 - cy0;
 	}
 }
+
+
+/* is b inside a? */
+bool jive_rect_contains(SDL_Rect *a, SDL_Rect *b) {
+	return b->x >= a->x && b->y >= a->y
+		&& b->x + b->w <= a->x + a->w
+		&& b->y + b->h <= a->y + a->h;
+}
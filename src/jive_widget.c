@@ -34,6 +34,18 @@ void jive_widget_pack(lua_State *L, int index, JiveWidget *data) {
 }
 
 
+/* for widgets with a background tile drawn over their bounds */
+void jive_widget_opaque_tile(JiveWidget *peer, JiveTile *tile, SDL_Rect *r) {
+	if (tile && jive_tile_is_opaque(tile)) {
+		memcpy(r, &peer->bounds, sizeof(*r));
+	}
+	else {
+		r->w = 0;
+		r->h = 0;
+	}
+}
+
+
 int jiveL_widget_set_bounds(lua_State *L) {
 	JiveWidget *peer;
 	SDL_Rect bounds;
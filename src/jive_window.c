@@ -14,6 +14,11 @@ typedef struct window_widget {
 
 	JiveTile *bg_tile;
 	JiveTile *mask_tile;
+
+	/* opaque_from found for the screen background, reused by the draw */
+	bool opaque_cached;
+	SDL_Rect opaque_clip;
+	int opaque_from;
 } WindowWidget;
 
 
@@ -168,8 +173,119 @@ int jiveL_window_iterate(lua_State *L) {
 }
 
 
+/*
+ * Find the last widget drawn that covers the clip with opaque pixels, so
+ * nothing drawn before it needs drawing. Returns its position in the
+ * widgets drawn, 0 if the window background covers the clip, or -1.
+ */
+static int opaque_from(lua_State *L, int index, WindowWidget *peer, JiveSurface *srf) {
+	SDL_Rect clip, r;
+	int i = 0, from = -1;
+
+	JIVEL_STACK_CHECK_BEGIN(L);
+
+	memset(&clip, 0, sizeof(clip));
+	jive_surface_get_clip(srf, &clip);
+
+	if ((peer->w.layer & JIVE_LAYER_ALL) && peer->bg_tile && jive_tile_is_opaque(peer->bg_tile)
+	    && jive_rect_contains(&peer->w.bounds, &clip)) {
+		from = 0;
+	}
+
+	/* window widgets in z order, as iterate */
+	lua_getfield(L, index, "zWidgets");
+	lua_pushnil(L);
+	while (lua_next(L, -2) != 0) {
+		JiveWidget *wpeer;
+
+		if (jive_getmethod(L, -1, "isHidden")) {
+			lua_pushvalue(L, -2);
+			lua_call(L, 1, 1);
+
+			if (lua_toboolean(L, -1)) {
+				lua_pop(L, 2);
+				continue;
+			}
+
+			lua_pop(L, 1);
+		}
+
+		i++;
+
+		lua_getfield(L, -1, "peer");
+		wpeer = lua_touserdata(L, -1);
+		lua_pop(L, 1);
+
+		if (!wpeer || !wpeer->opaque || !(wpeer->layer & JIVE_LAYER_ALL)) {
+			lua_pop(L, 1);
+			continue;
+		}
+
+		/* only trust widgets drawn by their own C code */
+		if (!jive_getmethod(L, -1, "draw")) {
+			lua_pop(L, 1);
+			continue;
+		}
+		if (!lua_iscfunction(L, -1)) {
+			lua_pop(L, 2);
+			continue;
+		}
+		lua_pop(L, 1);
+
+		wpeer->opaque(wpeer, &r);
+		if (r.w && r.h && jive_rect_contains(&r, &clip)) {
+			from = i;
+		}
+
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	JIVEL_STACK_CHECK_END(L);
+
+	return from;
+}
+
+
+/* does drawing the window at index cover the surface clip? */
+bool jive_window_is_opaque(lua_State *L, int index, JiveSurface *srf) {
+	WindowWidget *peer;
+
+	if (index < 0) {
+		index = lua_gettop(L) + index + 1;
+	}
+
+	/* a window drawn by Lua may draw anything */
+	if (!jive_getmethod(L, index, "draw")) {
+		return false;
+	}
+	if (lua_tocfunction(L, -1) != jiveL_window_draw) {
+		lua_pop(L, 1);
+		return false;
+	}
+	lua_pop(L, 1);
+
+	peer = jive_getpeer(L, index, &windowPeerMeta);
+
+	/* the window is drawn next with the same clip */
+	peer->opaque_from = opaque_from(L, index, peer, srf);
+	peer->opaque_cached = true;
+	jive_surface_get_clip(srf, &peer->opaque_clip);
+
+	return peer->opaque_from >= 0;
+}
+
+
 static int draw_closure(lua_State *L) {
 	Uint32 t0 = 0, t1 = 0;
+	int n = lua_tointeger(L, lua_upvalueindex(4)) + 1;
+
+	/* covered by a later widget? */
+	lua_pushinteger(L, n);
+	lua_replace(L, lua_upvalueindex(4));
+	if (n < lua_tointeger(L, lua_upvalueindex(3))) {
+		return 0;
+	}
 
 	if (perfwarn.draw) t0 = jive_jiffies();
 
@@ -207,12 +323,27 @@ int jiveL_window_draw(lua_State *L) {
 	JiveSurface *srf = *(JiveSurface **)lua_touserdata(L, 2);
 	Uint32 layer = luaL_optinteger(L, 3, JIVE_LAYER_ALL);
 	bool_t is_transparent, is_mask;
+	int from = -1;
+
+	/* skip drawing what is covered by an opaque widget */
+	if (layer == JIVE_LAYER_ALL) {
+		SDL_Rect clip;
+
+		jive_surface_get_clip(srf, &clip);
+		if (peer->opaque_cached && memcmp(&clip, &peer->opaque_clip, sizeof(clip)) == 0) {
+			from = peer->opaque_from;
+		}
+		else {
+			from = opaque_from(L, 1, peer, srf);
+		}
+	}
+	peer->opaque_cached = false;
 
 	lua_getfield(L, 1, "transparent");
-	is_transparent = lua_toboolean(L, -1);
+	is_transparent = lua_toboolean(L, -1) && from < 0;
 	lua_pop(L, 1);
 
-	is_mask = (layer & peer->w.layer) && peer->mask_tile;
+	is_mask = (layer & peer->w.layer) && peer->mask_tile && from < 0;
 
 	if ((is_transparent || is_mask) &&
 	    jive_getmethod(L, 1, "getLowerWindow")) {
@@ -247,7 +378,7 @@ int jiveL_window_draw(lua_State *L) {
 	}
 
 	/* window background */
-	if ((layer & peer->w.layer) && peer->bg_tile) {
+	if ((layer & peer->w.layer) && peer->bg_tile && from <= 0) {
 		jive_tile_blit(peer->bg_tile, srf, peer->w.bounds.x, peer->w.bounds.y, peer->w.bounds.w, peer->w.bounds.h);
 	}
 
@@ -256,8 +387,10 @@ int jiveL_window_draw(lua_State *L) {
 		lua_pushvalue(L, 1); // widget
 
 		lua_pushvalue(L, 2); // surface
-		lua_pushvalue(L, 3); // layer
-		lua_pushcclosure(L, draw_closure, 2);
+		lua_pushinteger(L, layer); // layer
+		lua_pushinteger(L, from); // first widget drawn
+		lua_pushinteger(L, 0); // widgets seen
+		lua_pushcclosure(L, draw_closure, 4);
 
 		lua_call(L, 2, 0);
 	}
@@ -17,11 +17,67 @@
 
 #define LOG_BUFFER_SIZE 512
 
+/* async ring size, must be a power of two */
+#define LOG_RING_SIZE 256
+
+/* writer thread batch interval in ms */
+#define LOG_WRITER_INTERVAL 50
+
 static enum log_priority appender_stdout = LOG_PRIORITY_DEBUG;
 static enum log_priority appender_syslog = LOG_PRIORITY_OFF;
 
+/* highest priority any appender will write, see log_category_is_enabled */
+enum log_priority log_appender_priority = LOG_PRIORITY_DEBUG;
+
 static struct log_category *category_head = NULL;
 
+
+/*
+ * Asynchronous logging. Callers format the message into a record in a
+ * bounded lock-free ring (multiple producers, one consumer), and a writer
+ * thread adds the timestamp formatting, colours and syslog line splitting
+ * and writes the records in batches. When the ring is full the message is
+ * dropped and counted, the writer reports the number of dropped messages.
+ * Before the writer is started, or after it is stopped, messages are
+ * written synchronously. Callers never take a lock, they count themselves
+ * in while queueing and the writer waits for them before its final drain.
+ */
+
+#if defined(__GNUC__)
+#define LOG_CAS(ptr, old, new) __sync_bool_compare_and_swap((ptr), (old), (new))
+#define LOG_INC(ptr) __sync_fetch_and_add((ptr), 1)
+#define LOG_DEC(ptr) __sync_fetch_and_sub((ptr), 1)
+#define LOG_BARRIER() __sync_synchronize()
+#elif defined(WIN32)
+#define LOG_CAS(ptr, old, new) (InterlockedCompareExchange((LONG volatile *)(ptr), (new), (old)) == (LONG)(old))
+#define LOG_INC(ptr) InterlockedIncrement((LONG volatile *)(ptr))
+#define LOG_DEC(ptr) InterlockedDecrement((LONG volatile *)(ptr))
+#define LOG_BARRIER() MemoryBarrier()
+#endif
+
+struct log_record {
+	volatile Uint32 seq;
+	struct log_category *category;
+	enum log_priority priority;
+	struct timeval t;
+	char buf[LOG_BUFFER_SIZE];
+};
+
+static struct log_record log_ring[LOG_RING_SIZE];
+static volatile Uint32 log_ring_tail;	/* next slot to fill */
+static Uint32 log_ring_head;		/* next slot to write, writer only */
+
+static volatile Uint32 log_dropped;
+static Uint32 log_dropped_reported;
+static volatile Uint32 log_written;
+
+static SDL_Thread *log_writer = NULL;
+static SDL_mutex *log_writer_lock = NULL;
+static SDL_cond *log_writer_cond = NULL;
+static volatile bool log_writer_quit = false;
+static volatile Uint32 log_producers;	/* callers queueing a record */
+static bool log_async = true;
+
 #if defined(WIN32)
 
 #if defined(_MSC_VER) || defined(_MSC_EXTENSIONS)
@@ -87,16 +143,229 @@ int gettimeofday(struct timeval *tv, struct timezone *tz)
 }
 #endif
 
+static void log_write(struct log_category *category, enum log_priority priority, struct timeval *t, char *buf) {
+	struct tm tm;
+
+	if (appender_stdout >= priority) {
+		char *color;
+
+		gmtime_r(&t->tv_sec, &tm);
+
+		switch (priority) {
+		case LOG_PRIORITY_ERROR:
+			color = "\033[0;31m";
+			break;
+		case LOG_PRIORITY_WARN:
+			color = "\033[0;32m";
+			break;
+		case LOG_PRIORITY_INFO:
+			color = "\033[0;33m";
+			break;
+		default:
+		case LOG_PRIORITY_DEBUG:
+			color = "\033[0;34m";
+		}
+
+#if defined(WIN32)
+		printf("%02d.%03ld %-6s %s - %s\n",
+		       t->tv_sec,
+		       (long)(t->tv_usec / 1000),
+		       log_priority_to_string(priority), category->name, buf);
+#else
+		printf("%s%04d%02d%02d %02d:%02d:%02d.%03ld %-6s %s - %s\033[0m\n",
+		       color,
+		       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+		       tm.tm_hour, tm.tm_min, tm.tm_sec,
+		       (long)(t->tv_usec / 1000),
+		       log_priority_to_string(priority), category->name, buf);
+
+#endif
+	}
+
+#ifdef HAVE_SYSLOG
+	if (appender_syslog >= priority) {
+		char *ptr, *lasts = NULL;
+
+		/* log individual lines to syslog */
+		ptr = strtok_r(buf, "\n", &lasts);
+		syslog(priority, "%-6s %s - %s", log_priority_to_string(priority), category->name, ptr);
+
+		ptr = strtok_r(NULL, "\n", &lasts);
+		while (ptr) {
+			syslog(priority, "%s", ptr);
+			ptr = strtok_r(NULL, "\n", &lasts);
+		}
+	}
+#endif
+}
+
+
+/* write all queued records, returns the number written */
+static int log_drain(void) {
+	struct log_record *r;
+	Uint32 dropped;
+	int n = 0;
+
+	while (1) {
+		r = &log_ring[log_ring_head & (LOG_RING_SIZE - 1)];
+		if (r->seq != log_ring_head + 1) {
+			/* empty, or the producer has not finished the record */
+			break;
+		}
+		LOG_BARRIER();
+
+		log_write(r->category, r->priority, &r->t, r->buf);
+
+		LOG_BARRIER();
+		r->seq = log_ring_head + LOG_RING_SIZE;
+		log_ring_head++;
+		n++;
+	}
+
+	dropped = log_dropped;
+	if (dropped != log_dropped_reported) {
+		printf("log: dropped %u messages\n", dropped - log_dropped_reported);
+		log_dropped_reported = dropped;
+	}
+
+	if (n) {
+		log_written += n;
+		fflush(stdout);
+	}
+
+	return n;
+}
+
+
+static int log_writer_thread(void *unused) {
+	SDL_LockMutex(log_writer_lock);
+	while (!log_writer_quit) {
+		SDL_CondWaitTimeout(log_writer_cond, log_writer_lock, LOG_WRITER_INTERVAL);
+
+		SDL_UnlockMutex(log_writer_lock);
+		log_drain();
+		SDL_LockMutex(log_writer_lock);
+	}
+	SDL_UnlockMutex(log_writer_lock);
+
+	return 0;
+}
+
+
+static void log_writer_stop(void) {
+	if (!log_writer) {
+		return;
+	}
+
+	SDL_LockMutex(log_writer_lock);
+	log_writer_quit = true;
+	SDL_CondSignal(log_writer_cond);
+	SDL_UnlockMutex(log_writer_lock);
+
+	SDL_WaitThread(log_writer, NULL);
+	log_writer = NULL;
+
+	/* callers that counted themselves in before seeing the quit flag
+	 * finish their records, later ones write synchronously
+	 */
+	LOG_BARRIER();
+	while (log_producers) {
+		SDL_Delay(1);
+	}
+
+	/* anything queued since the writer's last batch. the cond is left
+	 * for callers still signalling it, and never destroyed.
+	 */
+	log_drain();
+}
+
+
+static void log_writer_start(void) {
+	Uint32 i;
+
+	for (i = 0; i < LOG_RING_SIZE; i++) {
+		log_ring[i].seq = i;
+	}
+	log_ring_head = log_ring_tail = 0;
+
+	log_writer_lock = SDL_CreateMutex();
+	log_writer_cond = SDL_CreateCond();
+	log_writer_quit = false;
+
+	log_writer = SDL_CreateThread(log_writer_thread, NULL);
+	if (!log_writer) {
+		fprintf(stderr, "log: create writer thread failed, logging synchronously\n");
+		SDL_DestroyCond(log_writer_cond);
+		SDL_DestroyMutex(log_writer_lock);
+		log_writer_cond = NULL;
+		log_writer_lock = NULL;
+		return;
+	}
+
+	/* flush any queued messages on exit */
+	atexit(log_writer_stop);
+}
+
+
+/* returns false if the ring is full */
+static bool log_enqueue(struct log_category *category, enum log_priority priority, const char *format, va_list args) {
+	struct log_record *r;
+	Uint32 pos;
+
+	pos = log_ring_tail;
+	while (1) {
+		Sint32 dif;
+
+		r = &log_ring[pos & (LOG_RING_SIZE - 1)];
+		dif = (Sint32)(r->seq - pos);
+
+		if (dif == 0) {
+			if (LOG_CAS(&log_ring_tail, pos, pos + 1)) {
+				break;
+			}
+		}
+		else if (dif < 0) {
+			return false;
+		}
+
+		pos = log_ring_tail;
+	}
+
+	r->category = category;
+	r->priority = priority;
+	gettimeofday(&r->t, NULL);
+	vsnprintf(r->buf, LOG_BUFFER_SIZE, format, args);
+
+	LOG_BARRIER();
+	r->seq = pos + 1;
+
+	/* don't wait for the batch interval to write errors */
+	if (priority <= LOG_PRIORITY_ERROR) {
+		SDL_CondSignal(log_writer_cond);
+	}
+
+	return true;
+}
+
+
 void log_init() {
 #ifdef HAVE_SYSLOG
 	openlog("jivelite", LOG_ODELAY | LOG_CONS, LOG_USER);
 #endif
+
+	log_appender_priority = (appender_stdout > appender_syslog) ? appender_stdout : appender_syslog;
+
+	if (log_async) {
+		log_writer_start();
+	}
 }
 
 
 void log_free() {
 	struct log_category *next, *ptr = category_head;
 
+	log_writer_stop();
+
 #ifdef HAVE_SYSLOG
 	closelog();
 #endif
@@ -135,65 +404,30 @@ struct log_category *log_category_get(const char *name) {
 
 void log_category_vlog(struct log_category *category, enum log_priority priority, const char *format, va_list args) {
 	struct timeval t;
-	struct tm tm;
-
-	char *buf = alloca(LOG_BUFFER_SIZE);
-	vsnprintf(buf, LOG_BUFFER_SIZE, format, args);
-
-	if (appender_stdout >= priority) {
-		char *color;
+	char *buf;
 
-		gettimeofday(&t, NULL);
-		gmtime_r(&t.tv_sec, &tm);
+	/* counted in before the quit flag is checked, so the writer's final
+	 * drain waits for any record being queued
+	 */
+	if (log_writer_lock) {
+		LOG_INC(&log_producers);
 
-		switch (priority) {
-		case LOG_PRIORITY_ERROR:
-			color = "\033[0;31m";
-			break;
-		case LOG_PRIORITY_WARN:
-			color = "\033[0;32m";
-			break;
-		case LOG_PRIORITY_INFO:
-			color = "\033[0;33m";
-			break;
-		default:
-		case LOG_PRIORITY_DEBUG:
-			color = "\033[0;34m";
+		if (!log_writer_quit) {
+			if (!log_enqueue(category, priority, format, args)) {
+				LOG_INC(&log_dropped);
+			}
+			LOG_DEC(&log_producers);
+			return;
 		}
 
-#if defined(WIN32)
-		printf("%02d.%03ld %-6s %s - %s\n",
-		       t.tv_sec,
-		       (long)(t.tv_usec / 1000),
-		       log_priority_to_string(priority), category->name, buf);
-#else
-		printf("%s%04d%02d%02d %02d:%02d:%02d.%03ld %-6s %s - %s\033[0m\n",
-		       color,
-		       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
-		       tm.tm_hour, tm.tm_min, tm.tm_sec,
-		       (long)(t.tv_usec / 1000),
-		       log_priority_to_string(priority), category->name, buf);
-
-#endif
+		LOG_DEC(&log_producers);
 	}
 
-#ifdef HAVE_SYSLOG
-	if (appender_syslog >= priority) {
-		char *ptr, *lasts = NULL;
-
-		/* log individual lines to syslog */
-		ptr = strtok_r(buf, "\n", &lasts);
-		syslog(priority, "%-6s %s - %s", log_priority_to_string(priority), category->name, ptr);
-
-		ptr = strtok_r(NULL, "\n", &lasts);
-		while (ptr) {
-			syslog(priority, "%s", ptr);
-			ptr = strtok_r(NULL, "\n", &lasts);
-		}
-	}
-#endif
+	buf = alloca(LOG_BUFFER_SIZE);
+	vsnprintf(buf, LOG_BUFFER_SIZE, format, args);
 
-	return;
+	gettimeofday(&t, NULL);
+	log_write(category, priority, &t, buf);
 }
 
 
@@ -256,7 +490,7 @@ static int do_log(lua_State *L, enum log_priority priority, bool_t stacktrace) {
 	luaL_Buffer buf;
 	lua_Debug ar;
 	char *src;
-	int i, argc;
+	int i, argc, tostring;
 
 	/* stack is:
 	 * 1: log category
@@ -268,7 +502,8 @@ static int do_log(lua_State *L, enum log_priority priority, bool_t stacktrace) {
 		return 0;
 	};
 
-	if (log_category_get_priority(category) < priority) {
+	/* skip the stack walk and string conversion if nothing is written */
+	if (!log_category_is_enabled(category, priority)) {
 		return 0;
 	}
 
@@ -286,13 +521,21 @@ static int do_log(lua_State *L, enum log_priority priority, bool_t stacktrace) {
 		}
 	}
 
+	/* log arguments */
+	lua_getglobal(L, "tostring");
+	tostring = lua_gettop(L);
+
 	luaL_buffinit(L, &buf);
 
-	/* log arguments */
 	for (i=2; i<=argc; i++) {
-		lua_getglobal(L, "tostring");
-		lua_pushvalue(L, i);
-		lua_call(L, 1, 1);
+		if (lua_type(L, i) == LUA_TSTRING) {
+			lua_pushvalue(L, i);
+		}
+		else {
+			lua_pushvalue(L, tostring);
+			lua_pushvalue(L, i);
+			lua_call(L, 1, 1);
+		}
 
 		luaL_addvalue(&buf);
 	}
@@ -434,6 +677,20 @@ static int log_categories(lua_State *L) {
 }
 
 
+static int log_stats(lua_State *L) {
+	lua_createtable(L, 0, 3);
+
+	lua_pushinteger(L, log_written);
+	lua_setfield(L, -2, "written");
+	lua_pushinteger(L, log_dropped);
+	lua_setfield(L, -2, "dropped");
+	lua_pushboolean(L, log_writer != NULL);
+	lua_setfield(L, -2, "async");
+
+	return 1;
+}
+
+
 static const struct luaL_Reg log_m[] = {
 	{ "debug", log_debug },
 	{ "info", log_info },
@@ -452,6 +709,7 @@ static const struct luaL_Reg log_m[] = {
 static const struct luaL_Reg log_f[] = {
 	{ "logger", log_logger },
 	{ "categories", log_categories },
+	{ "stats", log_stats },
 	{ NULL, NULL }
 };
 
@@ -472,19 +730,20 @@ int luaopen_log(lua_State *L) {
 }
 
 
-int jive_log_init(lua_State *L) {
+static void log_configure(lua_State *L) {
 	char *log_path;
 
 	/* configure logging */
 	log_path = alloca(PATH_MAX);
 	if (!jive_find_file("logconf.lua", log_path)) {
-		return 0;
+		return;
 	}
 
 	/* load environment */
 	if (luaL_loadfile(L, log_path) != 0) {
 		fprintf(stderr, "error loading logconf: %s\n", lua_tostring(L, -1));
-		return 0;
+		lua_pop(L, 1);
+		return;
 	}
 
 	/* sandbox and evaluate environment */
@@ -492,8 +751,16 @@ int jive_log_init(lua_State *L) {
 	lua_setfenv(L, -2);
 	if (lua_pcall(L, 0, 1, 0) != 0) {
 		fprintf(stderr, "error in logconf: %s\n", lua_tostring(L, -1));
-		return 0;
+		lua_pop(L, 1);
+		return;
+	}
+
+	/* async = false to write messages on the calling thread */
+	lua_getfield(L, -1, "async");
+	if (lua_isboolean(L, -1)) {
+		log_async = lua_toboolean(L, -1);
 	}
+	lua_pop(L, 1);
 
 	/* configure appenders */
 	lua_getfield(L, -1, "appender");
@@ -525,8 +792,12 @@ int jive_log_init(lua_State *L) {
 			lua_pop(L, 1);
 		}
 	}
-	lua_pop(L, 1);
+	lua_pop(L, 2);
+}
+
 
+int jive_log_init(lua_State *L) {
+	log_configure(L);
 	log_init();
 
 	return 0;
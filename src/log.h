@@ -64,8 +64,17 @@ extern const char *log_priority_to_string(enum log_priority priority);
 extern enum log_priority log_priority_to_int(const char *str);
 
 
+extern enum log_priority log_appender_priority;
+
+
+/* true if a message would be written, use to avoid formatting costs */
+static __inline int log_category_is_enabled(struct log_category *category, enum log_priority priority) {
+	return category->priority >= priority && log_appender_priority >= priority;
+}
+
+
 static __inline void log_category_log(struct log_category *category, enum log_priority priority, const char *format, ...) {
-	if (category->priority >= priority) {
+	if (log_category_is_enabled(category, priority)) {
 		va_list va;
 		va_start(va, format);
 		log_category_vlog(category, priority, format, va);
@@ -300,26 +300,24 @@ int jive_find_file(const char *path, char *fullpath) {
 
 
 /*
- * 
+ * Write a file atomically, returns the name of the step that failed with
+ * errno set, or NULL.
  */
-static int system_atomic_write(lua_State *L)
+static const char *atomic_write(const char *fname, const char *fdata, size_t len)
 {
-	const char *fname, *fdata;
 	char *tname;
-	size_t n, len;
+	size_t n;
 	FILE *fp;
 #if HAVE_FSYNC && !defined(FSYNC_WORKAROUND_ENABLED)
 	DIR *dp;
 #endif
-	fname = lua_tostring(L, 2);
-	fdata = lua_tolstring(L, 3, &len);
 
 	tname = alloca(strlen(fname) + 5);
 	strcpy(tname, fname);
 	strcat(tname, ".new");
 	
 	if (!(fp = fopen(tname, "w"))) {
-		return luaL_error(L, "fopen: %s", strerror(errno));
+		return "fopen";
 	}
 
 	n = 0;
@@ -328,35 +326,35 @@ static int system_atomic_write(lua_State *L)
 
 		if (ferror(fp)) {
 			fclose(fp);
-			return luaL_error(L, "fwrite: %s", strerror(errno));
+			return "fwrite";
 		}
 	}
 
 	if (fflush(fp) != 0) {
 		fclose(fp);
-		return luaL_error(L, "fflush: %s", strerror(errno));
+		return "fflush";
 	}
 #if HAVE_FSYNC && !defined(FSYNC_WORKAROUND_ENABLED)
 	if (fsync(fileno(fp)) != 0) {
 		fclose(fp);
-		return luaL_error(L, "fsync: %s", strerror(errno));
+		return "fsync";
 	}
 #endif
 	if (fclose(fp) != 0) {
-		return luaL_error(L, "fclose: %s", strerror(errno));
+		return "fclose";
 	}
 
 #if defined(WIN32)
 	/* windows systems must delete old file first */
 	if (_access_s(fname, 0) == 0) {
 		if (remove(fname) != 0) {
-			return luaL_error(L, "remove old file: %s", strerror(errno));
+			return "remove old file";
 		}
 	}
 #endif
 
 	if (rename(tname, fname) != 0) {
-		return luaL_error(L, "rename: %s", strerror(errno));
+		return "rename";
 	}
 
 #ifdef FSYNC_WORKAROUND_ENABLED
@@ -364,19 +362,213 @@ static int system_atomic_write(lua_State *L)
 	sync();
 #elif HAVE_FSYNC
 	if (!(dp = opendir(dirname(tname)))) {
-		return luaL_error(L, "opendir: %s", strerror(errno));
+		return "opendir";
 	}
 	
 	if (fsync(dirfd(dp)) != 0) {
 		closedir(dp);
-		return luaL_error(L, "fsync: %s", strerror(errno));
+		return "fsync";
 	}
 
 	if (closedir(dp) != 0) {
-		return luaL_error(L, "closedir: %s", strerror(errno));
+		return "closedir";
 	}
 #endif
 
+	return NULL;
+}
+
+
+/*
+ * 
+ */
+static int system_atomic_write(lua_State *L)
+{
+	const char *fname, *fdata, *err;
+	size_t len;
+
+	fname = lua_tostring(L, 2);
+	fdata = lua_tolstring(L, 3, &len);
+
+	if ((err = atomic_write(fname, fdata, len))) {
+		return luaL_error(L, "%s: %s", err, strerror(errno));
+	}
+
+	return 0;
+}
+
+
+/*
+ * Background writes. The fsyncs in an atomic write can take tens of ms
+ * on flash, so files that do not need to be on disk before returning are
+ * written from a thread. A file queued again before it is written only
+ * gets the latest data.
+ */
+struct pending_write {
+	char *fname;
+	char *fdata;
+	size_t len;
+	struct pending_write *next;
+};
+
+static SDL_Thread *writer = NULL;
+static SDL_mutex *writer_lock;
+static SDL_cond *writer_cond, *writer_idle_cond;
+static struct pending_write *writer_head, *writer_tail;
+static bool writer_busy, writer_quit;
+static LOG_CATEGORY *log_writer;
+
+
+static void pending_write_free(struct pending_write *w) {
+	free(w->fname);
+	free(w->fdata);
+	free(w);
+}
+
+
+static int writer_thread(void *unused) {
+	struct pending_write *w;
+	const char *err;
+
+	SDL_LockMutex(writer_lock);
+	while (1) {
+		while (!writer_head && !writer_quit) {
+			SDL_CondWait(writer_cond, writer_lock);
+		}
+
+		/* on quit the queue is written first */
+		w = writer_head;
+		if (!w) {
+			break;
+		}
+
+		writer_head = w->next;
+		if (!writer_head) {
+			writer_tail = NULL;
+		}
+		writer_busy = true;
+		SDL_UnlockMutex(writer_lock);
+
+		if ((err = atomic_write(w->fname, w->fdata, w->len))) {
+			LOG_ERROR(log_writer, "%s %s: %s", err, w->fname, strerror(errno));
+		}
+		pending_write_free(w);
+
+		SDL_LockMutex(writer_lock);
+		writer_busy = false;
+		if (!writer_head) {
+			SDL_CondSignal(writer_idle_cond);
+		}
+	}
+	SDL_UnlockMutex(writer_lock);
+
+	return 0;
+}
+
+
+static void writer_stop(void) {
+	if (!writer) {
+		return;
+	}
+
+	SDL_LockMutex(writer_lock);
+	writer_quit = true;
+	SDL_CondSignal(writer_cond);
+	SDL_UnlockMutex(writer_lock);
+
+	SDL_WaitThread(writer, NULL);
+	writer = NULL;
+
+	SDL_DestroyCond(writer_cond);
+	SDL_DestroyCond(writer_idle_cond);
+	SDL_DestroyMutex(writer_lock);
+}
+
+
+static bool writer_start(void) {
+	log_writer = LOG_CATEGORY_GET("jivelite.system");
+
+	writer_lock = SDL_CreateMutex();
+	writer_cond = SDL_CreateCond();
+	writer_idle_cond = SDL_CreateCond();
+	writer_head = writer_tail = NULL;
+	writer_busy = writer_quit = false;
+
+	writer = SDL_CreateThread(writer_thread, NULL);
+	if (!writer) {
+		LOG_WARN(log_writer, "create writer thread failed, writing synchronously");
+		SDL_DestroyCond(writer_cond);
+		SDL_DestroyCond(writer_idle_cond);
+		SDL_DestroyMutex(writer_lock);
+		return false;
+	}
+
+	/* pending writes are finished on exit */
+	atexit(writer_stop);
+	return true;
+}
+
+
+static int system_atomic_write_async(lua_State *L)
+{
+	const char *fname, *fdata;
+	struct pending_write *w;
+	size_t len;
+
+	fname = luaL_checkstring(L, 2);
+	fdata = luaL_checklstring(L, 3, &len);
+
+	if (!writer && !writer_start()) {
+		return system_atomic_write(L);
+	}
+
+	SDL_LockMutex(writer_lock);
+
+	for (w = writer_head; w; w = w->next) {
+		if (strcmp(w->fname, fname) == 0) {
+			break;
+		}
+	}
+
+	if (w) {
+		free(w->fdata);
+	}
+	else {
+		w = calloc(sizeof(struct pending_write), 1);
+		w->fname = strdup(fname);
+
+		if (writer_tail) {
+			writer_tail->next = w;
+		}
+		else {
+			writer_head = w;
+		}
+		writer_tail = w;
+	}
+
+	w->fdata = malloc(len);
+	memcpy(w->fdata, fdata, len);
+	w->len = len;
+
+	SDL_CondSignal(writer_cond);
+	SDL_UnlockMutex(writer_lock);
+
+	return 0;
+}
+
+
+static int system_flush_writes(lua_State *L)
+{
+	if (!writer) {
+		return 0;
+	}
+
+	SDL_LockMutex(writer_lock);
+	while (writer_head || writer_busy) {
+		SDL_CondWait(writer_idle_cond, writer_lock);
+	}
+	SDL_UnlockMutex(writer_lock);
+
 	return 0;
 }
 
@@ -391,6 +583,8 @@ static const struct luaL_Reg jive_system_methods[] = {
 	{ "getUserDir", system_get_user_dir },
 	{ "findFile", system_find_file },
 	{ "atomicWrite", system_atomic_write },
+	{ "atomicWriteAsync", system_atomic_write_async },
+	{ "flushWrites", system_flush_writes },
 	{ "init", system_init },
 	{ NULL, NULL }
 };
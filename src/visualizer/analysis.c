@@ -0,0 +1,354 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "../common.h"
+#include "../jive.h"
+
+#include "visualizer.h"
+
+#include <pthread.h>
+
+/////////////////////////////////////////////////////////
+//
+// Analysis thread
+//
+// The spectrum and vu meter analysis runs on a background
+// thread at the analysis rate, and the results are published
+// through a seqlock. vis:spectrum() and vis:vumeter() return
+// the latest snapshot without waiting for the analysis or the
+// audio writer's lock. The newest samples for the scopes are
+// published the same way.
+//
+// With an analysis rate of 0 the analysis is run on the
+// calling thread, as it was before the analysis thread.
+//
+/////////////////////////////////////////////////////////
+
+// Default analysis rate in Hz
+#define ANALYSIS_RATE_DEFAULT 30
+
+// Stop analysing if the results have not been read for this
+// many ms, the meters are not on screen
+#define ANALYSIS_IDLE 1000
+
+// Reader retries before using the previous snapshot
+#define ANALYSIS_RETRIES 4
+
+// Most samples published for the scopes
+#define ANALYSIS_MAX_SAMPLES 8192
+
+// Held while analysing, and while the spectrum is reconfigured
+static pthread_mutex_t analysis_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t analysis_thread;
+static bool analysis_running = false;
+static volatile bool analysis_quit = false;
+static volatile int analysis_rate = ANALYSIS_RATE_DEFAULT;
+
+// Last time the snapshot was read, and the vu meter window asked for
+static volatile Uint32 analysis_read;
+static volatile int analysis_vumeter_window;
+
+// Published snapshot, seq is odd while it is being written
+static volatile u32_t snap_seq;
+static struct vis_snapshot snap_shared;
+
+// Analysis thread's working snapshot
+static struct vis_snapshot snap_work;
+
+// Reader's copies, UI thread only
+static struct vis_snapshot snap_read;
+static struct vis_snapshot snap_copy;
+
+// Last time the samples were read, and how many were asked for
+static volatile Uint32 samples_read;
+static volatile u32_t samples_window;
+
+// Published samples, the newest len samples ending at buffer
+// position idx, seq is odd while they are being written
+static volatile u32_t samples_seq;
+static s16_t samples_shared[ANALYSIS_MAX_SAMPLES];
+static u32_t samples_shared_len;
+static u32_t samples_shared_idx;
+static u32_t samples_shared_size;
+
+// Analysis thread's working samples
+static s16_t samples_work[ANALYSIS_MAX_SAMPLES];
+static u32_t samples_work_len;
+static u32_t samples_work_idx;
+static u32_t samples_work_size;
+
+
+void vis_analysis_lock(void) {
+	pthread_mutex_lock(&analysis_mutex);
+}
+
+void vis_analysis_unlock(void) {
+	pthread_mutex_unlock(&analysis_mutex);
+}
+
+static void analyse(struct vis_snapshot *snap) {
+	vis_analysis_lock();
+
+	vis_check();
+	snap->playing = vis_get_playing();
+
+	spectrum_analyse(snap);
+	vumeter_analyse(snap, analysis_vumeter_window);
+
+	vis_analysis_unlock();
+}
+
+static void publish(struct vis_snapshot *snap) {
+	snap_seq++;
+	__sync_synchronize();
+
+	snap_shared.playing = snap->playing;
+	snap_shared.num_bars[0] = snap->num_bars[0];
+	snap_shared.num_bars[1] = snap->num_bars[1];
+	memcpy(snap_shared.bins[0], snap->bins[0], snap->num_bars[0] * sizeof(int));
+	memcpy(snap_shared.bins[1], snap->bins[1], snap->num_bars[1] * sizeof(int));
+	snap_shared.rms[0] = snap->rms[0];
+	snap_shared.rms[1] = snap->rms[1];
+
+	__sync_synchronize();
+	snap_seq++;
+}
+
+static void capture_samples(void) {
+	u32_t window = samples_window;
+
+	samples_work_len = 0;
+
+	vis_analysis_lock();
+
+	samples_work_size = vis_get_buffer_len();
+	if (samples_work_size && vis_get_playing()) {
+		samples_work_idx = vis_get_buffer_idx();
+
+		// whole stereo frames only
+		window = MIN(window, samples_work_size) & ~1;
+		if (window && vis_read(samples_work, window, window)) {
+			samples_work_len = window;
+		}
+	}
+
+	vis_analysis_unlock();
+}
+
+static void publish_samples(void) {
+	samples_seq++;
+	__sync_synchronize();
+
+	memcpy(samples_shared, samples_work, samples_work_len * sizeof(s16_t));
+	samples_shared_len = samples_work_len;
+	samples_shared_idx = samples_work_idx;
+	samples_shared_size = samples_work_size;
+
+	__sync_synchronize();
+	samples_seq++;
+}
+
+static void *analysis_loop(void *unused) {
+	Uint32 next = jive_jiffies();
+
+	while (!analysis_quit) {
+		Uint32 now, interval;
+		int rate = analysis_rate;
+
+		interval = 1000 / (rate > 0 ? rate : ANALYSIS_RATE_DEFAULT);
+
+		if (jive_jiffies() - analysis_read < ANALYSIS_IDLE) {
+			analyse(&snap_work);
+			publish(&snap_work);
+		}
+
+		if (jive_jiffies() - samples_read < ANALYSIS_IDLE) {
+			capture_samples();
+			publish_samples();
+		}
+
+		next += interval;
+		now = jive_jiffies();
+		if ((Sint32)(next - now) > 0) {
+			usleep((next - now) * 1000);
+		}
+		else {
+			// fallen behind, don't try to catch up
+			next = now;
+		}
+	}
+
+	return NULL;
+}
+
+static void analysis_stop(void) {
+	if (!analysis_running) {
+		return;
+	}
+
+	analysis_quit = true;
+	pthread_join(analysis_thread, NULL);
+
+	analysis_running = false;
+}
+
+static void analysis_start(void) {
+	if (analysis_running) {
+		return;
+	}
+
+	analysis_quit = false;
+	if (pthread_create(&analysis_thread, NULL, analysis_loop, NULL) != 0) {
+		// fall back to analysing on the calling thread
+		analysis_rate = 0;
+		return;
+	}
+
+	analysis_running = true;
+}
+
+// Returns the latest analysis, vumeter_window is the number of
+// samples for the vu meter, or 0 to leave it unchanged
+const struct vis_snapshot *vis_analysis_snapshot(int vumeter_window) {
+	struct vis_snapshot *snap = &snap_read;
+	int retry;
+
+	analysis_read = jive_jiffies();
+	if (vumeter_window > 0) {
+		analysis_vumeter_window = vumeter_window;
+	}
+
+	if (analysis_rate <= 0) {
+		analyse(snap);
+		return snap;
+	}
+
+	analysis_start();
+
+	for (retry = 0; retry < ANALYSIS_RETRIES; retry++) {
+		u32_t seq = snap_seq;
+
+		if (seq & 1) {
+			continue;
+		}
+		__sync_synchronize();
+
+		snap_copy.playing = snap_shared.playing;
+		snap_copy.num_bars[0] = MIN(snap_shared.num_bars[0], MAX_SUBBANDS);
+		snap_copy.num_bars[1] = MIN(snap_shared.num_bars[1], MAX_SUBBANDS);
+		memcpy(snap_copy.bins[0], snap_shared.bins[0], snap_copy.num_bars[0] * sizeof(int));
+		memcpy(snap_copy.bins[1], snap_shared.bins[1], snap_copy.num_bars[1] * sizeof(int));
+		snap_copy.rms[0] = snap_shared.rms[0];
+		snap_copy.rms[1] = snap_shared.rms[1];
+
+		__sync_synchronize();
+		if (seq == snap_seq) {
+			snap->playing = snap_copy.playing;
+			snap->num_bars[0] = snap_copy.num_bars[0];
+			snap->num_bars[1] = snap_copy.num_bars[1];
+			memcpy(snap->bins[0], snap_copy.bins[0], snap_copy.num_bars[0] * sizeof(int));
+			memcpy(snap->bins[1], snap_copy.bins[1], snap_copy.num_bars[1] * sizeof(int));
+			snap->rms[0] = snap_copy.rms[0];
+			snap->rms[1] = snap_copy.rms[1];
+			break;
+		}
+	}
+
+	return snap;
+}
+
+// Parameters on the lua stack:
+//   2 - analysis rate in Hz, 0 to analyse on the calling thread
+int visualizer_analysis_rate(lua_State *L) {
+	int rate = luaL_optinteger(L, 2, ANALYSIS_RATE_DEFAULT);
+
+	if (rate <= 0) {
+		analysis_stop();
+		rate = 0;
+	}
+	else if (rate > 1000) {
+		rate = 1000;
+	}
+
+	analysis_rate = rate;
+
+	return 0;
+}
+
+// Copy the samples written since *pos, at most len and newest last, and
+// move *pos on. Used by the scopes, which need the samples rather than
+// the analysis. The samples come from the analysis thread's last publish,
+// so this never waits for the analysis. Returns the number of samples
+// copied.
+u32_t vis_analysis_read_new(u32_t *pos, s16_t *dst, u32_t len) {
+	u32_t idx, size, n;
+	int retry;
+
+	len = MIN(len, ANALYSIS_MAX_SAMPLES);
+
+	if (analysis_rate <= 0) {
+		// no analysis thread, read on the calling thread
+		vis_analysis_lock();
+
+		size = vis_get_buffer_len();
+		if (size == 0 || !vis_get_playing()) {
+			vis_analysis_unlock();
+			return 0;
+		}
+
+		idx = vis_get_buffer_idx();
+		n = (idx + size - (*pos % size)) % size;
+		*pos = idx;
+
+		// whole stereo frames only
+		n = MIN(n, len) & ~1;
+
+		if (n && !vis_read(dst, n, n)) {
+			n = 0;
+		}
+
+		vis_analysis_unlock();
+
+		return n;
+	}
+
+	samples_read = jive_jiffies();
+	samples_window = len;
+
+	analysis_start();
+
+	for (retry = 0; retry < ANALYSIS_RETRIES; retry++) {
+		u32_t seq = samples_seq;
+		u32_t avail;
+
+		if (seq & 1) {
+			continue;
+		}
+		__sync_synchronize();
+
+		idx = samples_shared_idx;
+		size = samples_shared_size;
+		avail = MIN(samples_shared_len, ANALYSIS_MAX_SAMPLES);
+
+		n = 0;
+		if (size && avail) {
+			n = (idx + size - (*pos % size)) % size;
+			n = MIN(n, MIN(avail, len)) & ~1;
+			memcpy(dst, samples_shared + avail - n, n * sizeof(s16_t));
+		}
+
+		__sync_synchronize();
+		if (seq == samples_seq) {
+			if (avail) {
+				*pos = idx;
+			}
+			return n;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,699 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "../common.h"
+#include "../jive.h"
+
+#include "visualizer.h"
+
+/////////////////////////////////////////////////////////
+//
+// Spectrum and VU meter widgets
+//
+// The peers render straight from the analysis snapshot.
+// The animation works out the bar, cap and tick state and
+// marks only the changed bars as dirty, draw then paints
+// the stored state so it is cheap to repeat when other
+// widgets dirty the same area.
+//
+/////////////////////////////////////////////////////////
+
+// max bin value from the spectrum analysis
+#define SPECTRUM_MAX_BIN 31
+
+typedef struct spectrum_widget {
+	JiveWidget w;
+
+	Uint32 bg_color;
+	Uint32 bar_color;
+	Uint32 cap_color;
+
+	int is_mono;
+	int cap_height[2];
+	int cap_space[2];
+	int channel_flipped[2];
+	int bars_in_bin[2];
+	int bar_width[2];
+	int bar_space[2];
+	int bin_space[2];
+	int clip_subbands[2];
+
+	// layout
+	bool ready;
+	int num_bars[2];
+	int bin_size[2];
+	float bar_height_multi[2];
+	int x[2];
+	int y;
+
+	// peak hold, and the state drawn for each bin
+	float cap[2][MAX_SUBBANDS];
+	Sint16 bar_px[2][MAX_SUBBANDS];
+	Sint16 cap_px[2][MAX_SUBBANDS];
+} SpectrumWidget;
+
+
+typedef struct vumeter_widget {
+	JiveWidget w;
+
+	bool analog;
+	JiveSurface *bg_img;
+	JiveSurface *tick_cap;
+	JiveSurface *tick_on;
+	JiveSurface *tick_off;
+
+	// layout
+	bool ready;
+	int x[2];
+	int y;
+	int width;
+	int height;
+	int bars;
+	Uint16 tw, th;
+
+	int val[2];
+	int cap[2];
+} VUMeterWidget;
+
+
+static int jiveL_spectrum_gc(lua_State *L);
+static int jiveL_vumeter_gc(lua_State *L);
+
+static JivePeerMeta spectrumPeerMeta = {
+	sizeof(SpectrumWidget),
+	"JiveSpectrumMeter",
+	jiveL_spectrum_gc,
+};
+
+static JivePeerMeta vumeterPeerMeta = {
+	sizeof(VUMeterWidget),
+	"JiveVUMeter",
+	jiveL_vumeter_gc,
+};
+
+
+// FIXME dynamic based on number of bars
+static const int rms_map[] = {
+	0, 2, 5, 7, 10, 21, 33, 45, 57, 82, 108, 133, 159, 200,
+	242, 284, 326, 387, 448, 509, 570, 652, 735, 817, 900,
+	1005, 1111, 1217, 1323, 1454, 1585, 1716, 1847, 2005,
+	2163, 2321, 2480, 2666, 2853, 3040, 3227, 3414, 3601,
+	3788, 3975, 4162, 4349, 4536,
+};
+
+
+// Read a { left, right } style value, a single value is used for both
+static void style_pair(lua_State *L, const char *key, int def, int value[2]) {
+	int i;
+
+	JIVEL_STACK_CHECK_BEGIN(L);
+
+	lua_pushcfunction(L, jiveL_style_value);
+	lua_pushvalue(L, 1);
+	lua_pushstring(L, key);
+	lua_pushnil(L);
+	lua_call(L, 3, 1);
+
+	for (i = 0; i < 2; i++) {
+		if (lua_istable(L, -1)) {
+			lua_rawgeti(L, -1, i + 1);
+		}
+		else {
+			lua_pushvalue(L, -1);
+		}
+
+		if (lua_isboolean(L, -1)) {
+			value[i] = lua_toboolean(L, -1);
+		}
+		else if (lua_isnumber(L, -1)) {
+			value[i] = lua_tointeger(L, -1);
+		}
+		else {
+			value[i] = def;
+		}
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+
+	JIVEL_STACK_CHECK_END(L);
+}
+
+
+static void replace_image(JiveSurface **dst, JiveSurface *img) {
+	if (*dst == img) {
+		return;
+	}
+
+	if (*dst) {
+		jive_surface_free(*dst);
+	}
+	*dst = jive_surface_ref(img);
+}
+
+
+static void redraw_union(SDL_Rect *dirty, Sint16 x, Sint16 y, Uint16 w, Uint16 h) {
+	SDL_Rect r;
+
+	r.x = x;
+	r.y = y;
+	r.w = w;
+	r.h = h;
+
+	if (dirty->w) {
+		jive_rect_union(dirty, &r, dirty);
+	}
+	else {
+		memcpy(dirty, &r, sizeof(SDL_Rect));
+	}
+}
+
+
+static int jiveL_spectrum_skin(lua_State *L) {
+	SpectrumWidget *peer;
+	int mono[2];
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	lua_pushcfunction(L, jiveL_style_path);
+	lua_pushvalue(L, -2);
+	lua_call(L, 1, 0);
+
+	peer = jive_getpeer(L, 1, &spectrumPeerMeta);
+	jive_widget_pack(L, 1, (JiveWidget *)peer);
+
+	peer->bg_color = jive_style_color(L, 1, "bg", 0xFFFFFFFF, NULL);
+	peer->bar_color = jive_style_color(L, 1, "barColor", 0xFFFFFFFF, NULL);
+	peer->cap_color = jive_style_color(L, 1, "capColor", 0xFFFFFFFF, NULL);
+
+	style_pair(L, "isMono", 0, mono);
+	peer->is_mono = mono[0];
+
+	style_pair(L, "capHeight", 0, peer->cap_height);
+	style_pair(L, "capSpace", 0, peer->cap_space);
+	style_pair(L, "channelFlipped", 0, peer->channel_flipped);
+	style_pair(L, "barsInBin", 1, peer->bars_in_bin);
+	style_pair(L, "barWidth", 1, peer->bar_width);
+	style_pair(L, "barSpace", 0, peer->bar_space);
+	style_pair(L, "binSpace", 0, peer->bin_space);
+	style_pair(L, "clipSubbands", 0, peer->clip_subbands);
+
+	return 0;
+}
+
+
+static int jiveL_spectrum_layout(lua_State *L) {
+	SpectrumWidget *peer;
+	int channel_width[2];
+	int ch, i;
+	int x, y, w, h, l, t, r, b;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &spectrumPeerMeta);
+
+	x = peer->w.bounds.x;
+	y = peer->w.bounds.y;
+	w = peer->w.bounds.w;
+	h = peer->w.bounds.h;
+	l = peer->w.padding.left;
+	t = peer->w.padding.top;
+	r = peer->w.padding.right;
+	b = peer->w.padding.bottom;
+
+	// When used in NP screen _layout gets called with strange values
+	if (w <= 0 && h <= 0) {
+		return 0;
+	}
+
+	for (ch = 0; ch < 2; ch++) {
+		peer->bars_in_bin[ch] = MAX(peer->bars_in_bin[ch], 1);
+		peer->bar_width[ch] = MAX(peer->bar_width[ch], 1);
+
+		peer->bin_size[ch] = peer->bar_width[ch] * peer->bars_in_bin[ch]
+			+ peer->bar_space[ch] * (peer->bars_in_bin[ch] - 1)
+			+ peer->bin_space[ch];
+
+		channel_width[ch] = (w - l - r) / 2;
+	}
+
+	// the analysis needs room for at least one bar
+	if (channel_width[0] < peer->bin_size[0] || channel_width[1] < peer->bin_size[1]) {
+		peer->ready = false;
+		return 0;
+	}
+
+	spectrum_configure(peer->is_mono, channel_width, peer->channel_flipped,
+			   peer->bin_size, peer->clip_subbands, peer->num_bars);
+
+	for (ch = 0; ch < 2; ch++) {
+		int bar_height = h - t - b - peer->cap_height[ch] - peer->cap_space[ch];
+
+		peer->num_bars[ch] = MIN(peer->num_bars[ch], MAX_SUBBANDS);
+		peer->bar_height_multi[ch] = (float) bar_height / SPECTRUM_MAX_BIN;
+
+		for (i = 0; i < peer->num_bars[ch]; i++) {
+			peer->cap[ch][i] = 0;
+			peer->bar_px[ch][i] = 0;
+			peer->cap_px[ch][i] = 0;
+		}
+	}
+
+	peer->x[0] = x + l + channel_width[0] - peer->num_bars[0] * peer->bin_size[0];
+	peer->x[1] = x + l + channel_width[1] + peer->bin_space[1];
+	peer->y = y + h - b;
+
+	peer->ready = true;
+
+	return 0;
+}
+
+
+static int jiveL_spectrum_animate(lua_State *L) {
+	SpectrumWidget *peer;
+	const struct vis_snapshot *snap;
+	SDL_Rect dirty;
+	int ch, i;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &spectrumPeerMeta);
+	if (!peer->ready) {
+		return 0;
+	}
+
+	snap = vis_analysis_snapshot(0);
+
+	memset(&dirty, 0, sizeof(dirty));
+
+	for (ch = 0; ch < 2; ch++) {
+		float multi = peer->bar_height_multi[ch];
+		float *cap = peer->cap[ch];
+		int first = -1, last = -1;
+
+		for (i = 0; i < peer->num_bars[ch]; i++) {
+			float bar = 0;
+			int bar_px, cap_px;
+
+			if (snap->playing && i < snap->num_bars[ch]) {
+				bar = snap->bins[ch][i] * multi;
+			}
+
+			if (bar >= cap[i]) {
+				cap[i] = bar;
+			}
+			else if (cap[i] > 0) {
+				cap[i] -= multi;
+				if (cap[i] < 0) {
+					cap[i] = 0;
+				}
+			}
+
+			bar_px = (int) bar;
+			cap_px = (int) cap[i];
+
+			if (bar_px != peer->bar_px[ch][i] || cap_px != peer->cap_px[ch][i]) {
+				peer->bar_px[ch][i] = bar_px;
+				peer->cap_px[ch][i] = cap_px;
+
+				if (first < 0) {
+					first = i;
+				}
+				last = i;
+			}
+		}
+
+		if (first >= 0) {
+			redraw_union(&dirty,
+				     peer->x[ch] + first * peer->bin_size[ch],
+				     peer->w.bounds.y,
+				     (last - first + 1) * peer->bin_size[ch],
+				     peer->w.bounds.h);
+		}
+	}
+
+	if (dirty.w) {
+		jive_redraw(&dirty);
+	}
+
+	return 0;
+}
+
+
+static void spectrum_draw_bins(SpectrumWidget *peer, JiveSurface *srf, int ch) {
+	int bar_size = peer->bar_width[ch] + peer->bar_space[ch];
+	int cap_height = peer->cap_height[ch];
+	int cap_space = peer->cap_space[ch];
+	int x = peer->x[ch];
+	int y = peer->y;
+	int i, k;
+
+	for (i = 0; i < peer->num_bars[ch]; i++) {
+		int bar_px = peer->bar_px[ch][i];
+		int cap_px = peer->cap_px[ch][i];
+
+		for (k = 0; k < peer->bars_in_bin[ch]; k++) {
+			int x1 = x + k * bar_size;
+			int x2 = x1 + peer->bar_width[ch] - 1;
+
+			// bar
+			if (bar_px > 0) {
+				jive_surface_boxColor(srf, x1, y, x2, y - bar_px + 1, peer->bar_color);
+			}
+
+			// cap
+			if (cap_height > 0) {
+				jive_surface_boxColor(srf, x1, y - cap_px - cap_space,
+						      x2, y - cap_px - cap_height - cap_space,
+						      peer->cap_color);
+			}
+		}
+
+		x += peer->bin_size[ch];
+	}
+}
+
+
+static int jiveL_spectrum_draw(lua_State *L) {
+
+	/* stack is:
+	 * 1: widget
+	 * 2: surface
+	 * 3: layer
+	 */
+
+	SpectrumWidget *peer = jive_getpeer(L, 1, &spectrumPeerMeta);
+	JiveSurface *srf = *(JiveSurface **)lua_touserdata(L, 2);
+	bool drawLayer = luaL_optinteger(L, 3, JIVE_LAYER_ALL) & peer->w.layer;
+
+	if (!drawLayer || !peer->ready) {
+		return 0;
+	}
+
+	if (peer->bg_color & 0xFF) {
+		jive_surface_boxColor(srf, peer->w.bounds.x, peer->w.bounds.y,
+				      peer->w.bounds.x + peer->w.bounds.w,
+				      peer->w.bounds.y + peer->w.bounds.h,
+				      peer->bg_color);
+	}
+
+	spectrum_draw_bins(peer, srf, 0);
+	spectrum_draw_bins(peer, srf, 1);
+
+	return 0;
+}
+
+
+static int jiveL_spectrum_gc(lua_State *L) {
+	luaL_checkudata(L, 1, spectrumPeerMeta.magic);
+
+	return 0;
+}
+
+
+static int jiveL_vumeter_skin(lua_State *L) {
+	VUMeterWidget *peer;
+	const char *style;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	lua_pushcfunction(L, jiveL_style_path);
+	lua_pushvalue(L, -2);
+	lua_call(L, 1, 0);
+
+	peer = jive_getpeer(L, 1, &vumeterPeerMeta);
+	jive_widget_pack(L, 1, (JiveWidget *)peer);
+
+	lua_getfield(L, 1, "style");
+	style = lua_tostring(L, -1);
+
+	if (style && strcmp(style, "vumeter_analog") == 0) {
+		peer->analog = true;
+
+		replace_image(&peer->bg_img, jive_style_image(L, 1, "bgImg", NULL));
+		replace_image(&peer->tick_cap, NULL);
+		replace_image(&peer->tick_on, NULL);
+		replace_image(&peer->tick_off, NULL);
+	}
+	else {
+		peer->analog = false;
+
+		replace_image(&peer->bg_img, jive_style_image(L, 1, "bgImg", NULL));
+		replace_image(&peer->tick_cap, jive_style_image(L, 1, "tickCap", NULL));
+		replace_image(&peer->tick_on, jive_style_image(L, 1, "tickOn", NULL));
+		replace_image(&peer->tick_off, jive_style_image(L, 1, "tickOff", NULL));
+	}
+	lua_pop(L, 1);
+
+	return 0;
+}
+
+
+static int jiveL_vumeter_layout(lua_State *L) {
+	VUMeterWidget *peer;
+	int x, y, w, h, l, t, r, b;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &vumeterPeerMeta);
+
+	x = peer->w.bounds.x;
+	y = peer->w.bounds.y;
+	w = peer->w.bounds.w;
+	h = peer->w.bounds.h;
+	l = peer->w.padding.left;
+	t = peer->w.padding.top;
+	r = peer->w.padding.right;
+	b = peer->w.padding.bottom;
+
+	// When used in NP screen _layout gets called with strange values
+	if ((w <= 0 || w > 480) && (h <= 0 || h > 272)) {
+		return 0;
+	}
+
+	peer->ready = false;
+
+	if (peer->analog) {
+		if (!peer->bg_img) {
+			return 0;
+		}
+
+		peer->x[0] = x;
+		peer->x[1] = x + w / 2;
+		peer->y = y;
+		peer->width = w / 2;
+		peer->height = h;
+	}
+	else {
+		if (!peer->tick_on || !peer->tick_cap || !peer->tick_off) {
+			return 0;
+		}
+
+		peer->width = w - l - r;
+		peer->height = h - t - b;
+
+		jive_surface_get_size(peer->tick_on, &peer->tw, &peer->th);
+		if (peer->th == 0) {
+			return 0;
+		}
+
+		peer->x[0] = x + l + (peer->width - peer->tw * 2) / 3;
+		peer->x[1] = x + l + ((peer->width - peer->tw * 2) * 2) / 3 + peer->tw;
+
+		peer->bars = peer->height / peer->th;
+		peer->y = y + t + peer->height;
+	}
+
+	peer->val[0] = peer->val[1] = 0;
+	peer->cap[0] = peer->cap[1] = 0;
+	peer->ready = true;
+
+	return 0;
+}
+
+
+static int vumeter_level(s32_t rms) {
+	int lo = 0, hi = sizeof(rms_map) / sizeof(rms_map[0]);
+
+	// number of map entries below the rms, the map is ascending
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (rms > rms_map[mid]) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+
+	// FIXME when rms map scaled
+	return MAX(lo, 1) / 2;
+}
+
+
+static int jiveL_vumeter_animate(lua_State *L) {
+	VUMeterWidget *peer;
+	const struct vis_snapshot *snap;
+	SDL_Rect dirty;
+	int ch;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &vumeterPeerMeta);
+	if (!peer->ready) {
+		return 0;
+	}
+
+	snap = vis_analysis_snapshot(0);
+
+	memset(&dirty, 0, sizeof(dirty));
+
+	for (ch = 0; ch < 2; ch++) {
+		int val = vumeter_level(snap->playing ? snap->rms[ch] : 0);
+		int cap = peer->cap[ch];
+
+		if (val >= cap) {
+			cap = val;
+		}
+		else if (cap > 0) {
+			cap--;
+		}
+
+		if (val == peer->val[ch] && cap == peer->cap[ch]) {
+			continue;
+		}
+
+		peer->val[ch] = val;
+		peer->cap[ch] = cap;
+
+		if (peer->analog) {
+			redraw_union(&dirty, peer->x[ch], peer->y, peer->width, peer->height);
+		}
+		else {
+			redraw_union(&dirty, peer->x[ch], peer->y - (peer->bars - 1) * peer->th,
+				     peer->tw, peer->bars * peer->th);
+		}
+	}
+
+	if (dirty.w) {
+		jive_redraw(&dirty);
+	}
+
+	return 0;
+}
+
+
+static int jiveL_vumeter_draw(lua_State *L) {
+
+	/* stack is:
+	 * 1: widget
+	 * 2: surface
+	 * 3: layer
+	 */
+
+	VUMeterWidget *peer = jive_getpeer(L, 1, &vumeterPeerMeta);
+	JiveSurface *srf = *(JiveSurface **)lua_touserdata(L, 2);
+	bool drawLayer = luaL_optinteger(L, 3, JIVE_LAYER_ALL) & peer->w.layer;
+	int ch, i;
+
+	if (!drawLayer || !peer->ready) {
+		return 0;
+	}
+
+	if (peer->analog) {
+		for (ch = 0; ch < 2; ch++) {
+			jive_surface_blit_clip(peer->bg_img, peer->cap[ch] * peer->width, peer->y,
+					       peer->width, peer->height, srf, peer->x[ch], peer->y);
+		}
+		return 0;
+	}
+
+	if (peer->bg_img) {
+		jive_surface_blit(peer->bg_img, srf, peer->w.bounds.x, peer->w.bounds.y);
+	}
+
+	for (ch = 0; ch < 2; ch++) {
+		int cap = peer->cap[ch] / 2;
+		int y = peer->y;
+
+		for (i = 1; i <= peer->bars; i++) {
+			if (i == cap) {
+				jive_surface_blit(peer->tick_cap, srf, peer->x[ch], y);
+			}
+			else if (i < peer->val[ch]) {
+				jive_surface_blit(peer->tick_on, srf, peer->x[ch], y);
+			}
+			else {
+				jive_surface_blit(peer->tick_off, srf, peer->x[ch], y);
+			}
+
+			y -= peer->th;
+		}
+	}
+
+	return 0;
+}
+
+
+static int jiveL_vumeter_gc(lua_State *L) {
+	VUMeterWidget *peer;
+
+	luaL_checkudata(L, 1, vumeterPeerMeta.magic);
+
+	peer = lua_touserdata(L, 1);
+
+	replace_image(&peer->bg_img, NULL);
+	replace_image(&peer->tick_cap, NULL);
+	replace_image(&peer->tick_on, NULL);
+	replace_image(&peer->tick_off, NULL);
+
+	return 0;
+}
+
+
+static const struct luaL_Reg spectrum_methods[] = {
+	{ "_skin", jiveL_spectrum_skin },
+	{ "_layout", jiveL_spectrum_layout },
+	{ "_animate", jiveL_spectrum_animate },
+	{ "draw", jiveL_spectrum_draw },
+	{ NULL, NULL }
+};
+
+
+static const struct luaL_Reg vumeter_methods[] = {
+	{ "_skin", jiveL_vumeter_skin },
+	{ "_layout", jiveL_vumeter_layout },
+	{ "_animate", jiveL_vumeter_animate },
+	{ "draw", jiveL_vumeter_draw },
+	{ NULL, NULL }
+};
+
+
+// Registers the widget methods in jive.vis.SpectrumMeter and
+// jive.vis.VUMeter, module() in the lua classes picks up these
+// tables, in the same way as the jive.ui widgets. The jive.vis
+// table is at the top of the stack.
+void visualizer_meters_register(lua_State *L) {
+	lua_newtable(L);
+	luaL_register(L, NULL, spectrum_methods);
+	lua_setfield(L, -2, "SpectrumMeter");
+
+	lua_newtable(L);
+	luaL_register(L, NULL, vumeter_methods);
+	lua_setfield(L, -2, "VUMeter");
+}
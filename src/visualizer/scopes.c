@@ -0,0 +1,500 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "../common.h"
+#include "../jive.h"
+
+#include "visualizer.h"
+
+/////////////////////////////////////////////////////////
+//
+// Oscilloscope and spectrogram widgets
+//
+// Both keep their history in a surface the size of the
+// widget, used as a ring of columns. Each frame only the
+// newest columns are rendered into the ring, and draw
+// scrolls the history by blitting the ring in two parts
+// either side of the write position.
+//
+/////////////////////////////////////////////////////////
+
+// Most samples read for the oscilloscope in one frame
+#define SCOPE_MAX_SAMPLES 8192
+
+// Levels in the spectrogram palette, the spectrum bins are 0..31
+#define SPECTROGRAM_LEVELS 32
+
+typedef struct scope_history {
+	JiveSurface *srf;
+	Uint16 width;
+	Uint16 height;
+	Uint16 head;		// next column to write
+	bool silent;		// last column written was silence
+} ScopeHistory;
+
+typedef struct oscilloscope_widget {
+	JiveWidget w;
+
+	Uint32 bg_color;
+	Uint32 color[2];
+	int is_mono;
+	int scroll_speed;
+
+	ScopeHistory history;
+	u32_t pos;
+} OscilloscopeWidget;
+
+typedef struct spectrogram_widget {
+	JiveWidget w;
+
+	Uint32 palette[SPECTROGRAM_LEVELS];
+	int bin_height;
+	int scroll_speed;
+
+	ScopeHistory history;
+	int num_bins;
+	int row_height;
+} SpectrogramWidget;
+
+
+static int jiveL_oscilloscope_gc(lua_State *L);
+static int jiveL_spectrogram_gc(lua_State *L);
+
+static JivePeerMeta oscilloscopePeerMeta = {
+	sizeof(OscilloscopeWidget),
+	"JiveOscilloscope",
+	jiveL_oscilloscope_gc,
+};
+
+static JivePeerMeta spectrogramPeerMeta = {
+	sizeof(SpectrogramWidget),
+	"JiveSpectrogram",
+	jiveL_spectrogram_gc,
+};
+
+// samples read by the oscilloscope, UI thread only
+static s16_t scope_buf[SCOPE_MAX_SAMPLES];
+
+
+static void history_free(ScopeHistory *h) {
+	if (h->srf) {
+		jive_surface_free(h->srf);
+		h->srf = NULL;
+	}
+}
+
+
+// Allocate the history for the widget's content area, cleared to bg
+static bool history_layout(ScopeHistory *h, JiveWidget *peer, Uint32 bg) {
+	int w = peer->bounds.w - peer->padding.left - peer->padding.right;
+	int ht = peer->bounds.h - peer->padding.top - peer->padding.bottom;
+
+	if (w <= 0 || ht <= 0) {
+		history_free(h);
+		return false;
+	}
+
+	if (!h->srf || h->width != w || h->height != ht) {
+		history_free(h);
+
+		h->srf = jive_surface_newRGB(w, ht);
+		if (!h->srf) {
+			return false;
+		}
+		h->width = w;
+		h->height = ht;
+	}
+
+	jive_surface_boxColor(h->srf, 0, 0, w - 1, ht - 1, bg);
+	h->head = 0;
+	h->silent = true;
+
+	return true;
+}
+
+
+// Move on to the next column, and mark the content area dirty
+static void history_advance(ScopeHistory *h, JiveWidget *peer, int columns) {
+	SDL_Rect r;
+
+	h->head = (h->head + columns) % h->width;
+
+	r.x = peer->bounds.x + peer->padding.left;
+	r.y = peer->bounds.y + peer->padding.top;
+	r.w = h->width;
+	r.h = h->height;
+	jive_redraw(&r);
+}
+
+
+// Blit the history, oldest column on the left
+static void history_draw(ScopeHistory *h, JiveWidget *peer, JiveSurface *dst) {
+	int x = peer->bounds.x + peer->padding.left;
+	int y = peer->bounds.y + peer->padding.top;
+
+	jive_surface_blit_clip(h->srf, h->head, 0, h->width - h->head, h->height, dst, x, y);
+	if (h->head) {
+		jive_surface_blit_clip(h->srf, 0, 0, h->head, h->height, dst, x + h->width - h->head, y);
+	}
+}
+
+
+static int jiveL_oscilloscope_skin(lua_State *L) {
+	OscilloscopeWidget *peer;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	lua_pushcfunction(L, jiveL_style_path);
+	lua_pushvalue(L, -2);
+	lua_call(L, 1, 0);
+
+	peer = jive_getpeer(L, 1, &oscilloscopePeerMeta);
+	jive_widget_pack(L, 1, (JiveWidget *)peer);
+
+	peer->bg_color = jive_style_color(L, 1, "bg", 0x000000FF, NULL) | 0xFF;
+	peer->color[0] = jive_style_color(L, 1, "leftColor", 0x14BCBCFF, NULL);
+	peer->color[1] = jive_style_color(L, 1, "rightColor", peer->color[0], NULL);
+	peer->is_mono = jive_style_int(L, 1, "isMono", 0);
+	peer->scroll_speed = MAX(jive_style_int(L, 1, "scrollSpeed", 2), 1);
+
+	return 0;
+}
+
+
+static int jiveL_oscilloscope_layout(lua_State *L) {
+	OscilloscopeWidget *peer;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &oscilloscopePeerMeta);
+
+	history_layout(&peer->history, (JiveWidget *)peer, peer->bg_color);
+
+	return 0;
+}
+
+
+// Draw the min/max envelope of frames samples as one column
+static void oscilloscope_column(OscilloscopeWidget *peer, int x, s16_t *samples, int frames) {
+	ScopeHistory *h = &peer->history;
+	int channels = peer->is_mono ? 1 : 2;
+	int lane = h->height / channels;
+	int ch, i;
+
+	jive_surface_vlineColor(h->srf, x, 0, h->height - 1, peer->bg_color);
+
+	for (ch = 0; ch < channels; ch++) {
+		int lo = 0, hi = 0;
+		int mid = lane * ch + lane / 2;
+
+		for (i = 0; i < frames; i++) {
+			int s;
+
+			if (peer->is_mono) {
+				s = (samples[2 * i] + samples[2 * i + 1]) / 2;
+			}
+			else {
+				s = samples[2 * i + ch];
+			}
+
+			lo = MIN(lo, s);
+			hi = MAX(hi, s);
+		}
+
+		jive_surface_vlineColor(h->srf, x,
+					mid - (hi * lane / 2) / 32768,
+					mid - (lo * lane / 2) / 32768,
+					peer->color[ch]);
+	}
+}
+
+
+static int jiveL_oscilloscope_animate(lua_State *L) {
+	OscilloscopeWidget *peer;
+	ScopeHistory *h;
+	const struct vis_snapshot *snap;
+	int frames, per_column, i;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &oscilloscopePeerMeta);
+	h = &peer->history;
+	if (!h->srf) {
+		return 0;
+	}
+
+	// keeps the analysis, and the shared memory check, running
+	snap = vis_analysis_snapshot(0);
+
+	frames = 0;
+	if (snap->playing) {
+		frames = vis_analysis_read_new(&peer->pos, scope_buf, SCOPE_MAX_SAMPLES) / 2;
+
+		// the samples are published at the analysis rate, not every
+		// frame, so wait for the next batch rather than leave a gap
+		if (frames < peer->scroll_speed) {
+			return 0;
+		}
+		h->silent = false;
+	}
+	else {
+		// blank the columns once, the history does not move while paused
+		if (h->silent) {
+			return 0;
+		}
+		h->silent = true;
+	}
+
+	per_column = frames / peer->scroll_speed;
+
+	for (i = 0; i < peer->scroll_speed; i++) {
+		int x = (h->head + i) % h->width;
+
+		oscilloscope_column(peer, x, scope_buf + 2 * i * per_column, per_column);
+	}
+
+	history_advance(h, (JiveWidget *)peer, peer->scroll_speed);
+
+	return 0;
+}
+
+
+static int jiveL_oscilloscope_draw(lua_State *L) {
+
+	/* stack is:
+	 * 1: widget
+	 * 2: surface
+	 * 3: layer
+	 */
+
+	OscilloscopeWidget *peer = jive_getpeer(L, 1, &oscilloscopePeerMeta);
+	JiveSurface *srf = *(JiveSurface **)lua_touserdata(L, 2);
+	bool drawLayer = luaL_optinteger(L, 3, JIVE_LAYER_ALL) & peer->w.layer;
+
+	if (drawLayer && peer->history.srf) {
+		history_draw(&peer->history, (JiveWidget *)peer, srf);
+	}
+
+	return 0;
+}
+
+
+static int jiveL_oscilloscope_gc(lua_State *L) {
+	OscilloscopeWidget *peer;
+
+	luaL_checkudata(L, 1, oscilloscopePeerMeta.magic);
+
+	peer = lua_touserdata(L, 1);
+	history_free(&peer->history);
+
+	return 0;
+}
+
+
+static Uint32 color_mix(Uint32 a, Uint32 b, int n, int d) {
+	Uint32 col = 0;
+	int shift;
+
+	for (shift = 0; shift < 32; shift += 8) {
+		int ca = (a >> shift) & 0xFF;
+		int cb = (b >> shift) & 0xFF;
+
+		col |= (Uint32)(ca + (cb - ca) * n / d) << shift;
+	}
+
+	return col;
+}
+
+
+static int jiveL_spectrogram_skin(lua_State *L) {
+	SpectrogramWidget *peer;
+	Uint32 bg, low, high;
+	int i;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	lua_pushcfunction(L, jiveL_style_path);
+	lua_pushvalue(L, -2);
+	lua_call(L, 1, 0);
+
+	peer = jive_getpeer(L, 1, &spectrogramPeerMeta);
+	jive_widget_pack(L, 1, (JiveWidget *)peer);
+
+	bg = jive_style_color(L, 1, "bg", 0x000000FF, NULL) | 0xFF;
+	low = jive_style_color(L, 1, "lowColor", 0x7456A1FF, NULL) | 0xFF;
+	high = jive_style_color(L, 1, "highColor", 0x14BCBCFF, NULL) | 0xFF;
+
+	// silence is the background, then a ramp from low to high
+	peer->palette[0] = bg;
+	for (i = 1; i < SPECTROGRAM_LEVELS; i++) {
+		peer->palette[i] = color_mix(low, high, i - 1, SPECTROGRAM_LEVELS - 2);
+	}
+
+	peer->bin_height = MAX(jive_style_int(L, 1, "binHeight", 2), 1);
+	peer->scroll_speed = MAX(jive_style_int(L, 1, "scrollSpeed", 1), 1);
+
+	return 0;
+}
+
+
+static int jiveL_spectrogram_layout(lua_State *L) {
+	SpectrogramWidget *peer;
+	ScopeHistory *h;
+	int width[2], flipped[2], size[2], clip[2], bars[2];
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &spectrogramPeerMeta);
+	h = &peer->history;
+
+	if (!history_layout(h, (JiveWidget *)peer, peer->palette[0])) {
+		return 0;
+	}
+
+	if (h->height < peer->bin_height) {
+		history_free(h);
+		return 0;
+	}
+
+	// one mono channel, the frequency axis runs up the widget
+	width[0] = width[1] = h->height;
+	flipped[0] = flipped[1] = 0;
+	size[0] = size[1] = peer->bin_height;
+	clip[0] = clip[1] = 0;
+
+	spectrum_configure(1, width, flipped, size, clip, bars);
+
+	peer->num_bins = MIN(bars[0], MAX_SUBBANDS);
+	peer->row_height = peer->num_bins ? h->height / peer->num_bins : 0;
+
+	return 0;
+}
+
+
+static int jiveL_spectrogram_animate(lua_State *L) {
+	SpectrogramWidget *peer;
+	ScopeHistory *h;
+	const struct vis_snapshot *snap;
+	bool silent;
+	int i, x1, x2;
+
+	/* stack is:
+	 * 1: widget
+	 */
+
+	peer = jive_getpeer(L, 1, &spectrogramPeerMeta);
+	h = &peer->history;
+	if (!h->srf || peer->row_height == 0) {
+		return 0;
+	}
+
+	snap = vis_analysis_snapshot(0);
+
+	silent = !snap->playing;
+	if (silent && h->silent) {
+		return 0;
+	}
+	h->silent = silent;
+
+	x1 = h->head;
+	x2 = MIN(h->head + peer->scroll_speed, h->width) - 1;
+
+	for (i = 0; i < peer->num_bins; i++) {
+		int level = 0;
+		int y = h->height - (i + 1) * peer->row_height;
+
+		if (!silent && i < snap->num_bars[0]) {
+			level = MAX(MIN(snap->bins[0][i], SPECTROGRAM_LEVELS - 1), 0);
+		}
+
+		jive_surface_boxColor(h->srf, x1, y, x2, y + peer->row_height - 1, peer->palette[level]);
+	}
+
+	// the rows above the last bin
+	if (h->height > peer->num_bins * peer->row_height) {
+		jive_surface_boxColor(h->srf, x1, 0, x2,
+				      h->height - peer->num_bins * peer->row_height - 1,
+				      peer->palette[0]);
+	}
+
+	history_advance(h, (JiveWidget *)peer, x2 - x1 + 1);
+
+	return 0;
+}
+
+
+static int jiveL_spectrogram_draw(lua_State *L) {
+
+	/* stack is:
+	 * 1: widget
+	 * 2: surface
+	 * 3: layer
+	 */
+
+	SpectrogramWidget *peer = jive_getpeer(L, 1, &spectrogramPeerMeta);
+	JiveSurface *srf = *(JiveSurface **)lua_touserdata(L, 2);
+	bool drawLayer = luaL_optinteger(L, 3, JIVE_LAYER_ALL) & peer->w.layer;
+
+	if (drawLayer && peer->history.srf) {
+		history_draw(&peer->history, (JiveWidget *)peer, srf);
+	}
+
+	return 0;
+}
+
+
+static int jiveL_spectrogram_gc(lua_State *L) {
+	SpectrogramWidget *peer;
+
+	luaL_checkudata(L, 1, spectrogramPeerMeta.magic);
+
+	peer = lua_touserdata(L, 1);
+	history_free(&peer->history);
+
+	return 0;
+}
+
+
+static const struct luaL_Reg oscilloscope_methods[] = {
+	{ "_skin", jiveL_oscilloscope_skin },
+	{ "_layout", jiveL_oscilloscope_layout },
+	{ "_animate", jiveL_oscilloscope_animate },
+	{ "draw", jiveL_oscilloscope_draw },
+	{ NULL, NULL }
+};
+
+
+static const struct luaL_Reg spectrogram_methods[] = {
+	{ "_skin", jiveL_spectrogram_skin },
+	{ "_layout", jiveL_spectrogram_layout },
+	{ "_animate", jiveL_spectrogram_animate },
+	{ "draw", jiveL_spectrogram_draw },
+	{ NULL, NULL }
+};
+
+
+// Registers jive.vis.Oscilloscope and jive.vis.Spectrogram, as
+// visualizer_meters_register. The jive.vis table is at the top of
+// the stack.
+void visualizer_scopes_register(lua_State *L) {
+	lua_newtable(L);
+	luaL_register(L, NULL, oscilloscope_methods);
+	lua_setfield(L, -2, "Oscilloscope");
+
+	lua_newtable(L);
+	luaL_register(L, NULL, spectrogram_methods);
+	lua_setfield(L, -2, "Spectrogram");
+}
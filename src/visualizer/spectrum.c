@@ -8,7 +8,7 @@
 #include "../jive.h"
 
 #include "visualizer.h"
-#include "kiss_fft.h"
+#include "spectrum_fft.h"
 
 #include <math.h>
 
@@ -28,21 +28,18 @@ static int power_map[32] = {
   1371400, 1501931, 1639645, 1784670, 1937131
 }; 
 
-#define X_SCALE_LOG 20
-
-// The maximum number of input samples sent to the FFT.
-// This is the actual number of input points for a combined
-// stereo signal.
-// For separate stereo signals, the number of input points for
-// each signal is half of the value.
-#define MAX_SAMPLE_WINDOW 1024 * X_SCALE_LOG
-
-// The maximum number of subbands forming the output of the FFT.
-// The is the actual number of output points for a combined
-// stereo signal.
-// For separate stereo signals, the number of output points for
+// X_SCALE_LOG, MAX_SAMPLE_WINDOW and MAX_SUBBANDS are in visualizer.h,
+// they also size the analysis snapshot.
+//
+// MAX_SAMPLE_WINDOW is the maximum number of input samples sent to the
+// FFT. This is the actual number of input points for a combined stereo
+// signal. For separate stereo signals, the number of input points for
 // each signal is half of the value.
-#define MAX_SUBBANDS MAX_SAMPLE_WINDOW / 2 / X_SCALE_LOG
+//
+// MAX_SUBBANDS is the maximum number of subbands forming the output of
+// the FFT. The is the actual number of output points for a combined
+// stereo signal. For separate stereo signals, the number of output
+// points for each signal is half of the value.
 
 // The minimum size of the FFT that we'll do.
 #define MIN_SUBBANDS 16
@@ -108,11 +105,12 @@ static int is_mono;
 // A Hamming window used on the input samples. This could be
 // precalculated for a fixed window size. Right now, we're
 // computing it in the begin() method.
-double filter_window[MAX_SAMPLE_WINDOW];
+float filter_window[MAX_SAMPLE_WINDOW];
 
 // Preemphasis applied to the subbands. This is precomputed
-// based on a db/KHz value.
-double preemphasis[MAX_SUBBANDS];
+// based on a db/KHz value, and includes the 1/65536 scaling
+// of the power.
+float preemphasis[MAX_SUBBANDS];
 
 // Lookup table to index the FFT result into the subband to
 // produce a log scale on the x axis
@@ -123,46 +121,40 @@ int decade_len[MAX_SUBBANDS];
 // For a small window size, this could be stack based.
 float avg_power[2 * MAX_SUBBANDS];
 
-kiss_fft_cfg cfg = NULL;
+// The FFT kernel is selected at build time, SPECTRUM_FFT=real selects
+// the real input FFT. Run make bench to compare the kernels on the
+// target, they are level on x86 so the packed complex FFT is the default.
+#ifdef SPECTRUM_REAL_FFT
+#define SPECTRUM_FFT_MODE SPECTRUM_FFT_REAL
+#else
+#define SPECTRUM_FFT_MODE SPECTRUM_FFT_COMPLEX
+#endif
 
-// Parameters on the lua stack for the spectrum analyzer:
-//   2 - Channels: stereo == 0, mono == 1
-// Left channel parameters:
-//   3 - Width in pixels
-//   4 - orientation: left to right == 0, right to left == 1
-//   5 - Bar size in pixels
-//   6 - Clipping: show all subbands == 0, clip higher subbands == 1
-// Right channel parameters (not required for mono):
-//   7-10 - same as left channel parameters
+static struct spectrum_fft fft;
+static int fft_ready = 0;
 
-int visualizer_spectrum_init( lua_State *L) {
+// The samples copied from the shared buffer, only used with the
+// analysis lock held so can be static rather than on the stack.
+static s16_t sample_buf[MAX_SAMPLE_WINDOW * 2];
+
+// Configure the analyser for the channel layout, the arrays are
+// indexed by channel and the right channel is ignored for mono.
+// The number of bars for each channel is returned in bars.
+void spectrum_configure( int mono, const int width[2], const int flipped[2], const int size[2], const int clip[2], int bars[2]) {
 	int l2int = 0;
 	int shiftsubbands;
+	int ch;
 
-	is_mono = luaL_optinteger(L, 2, 0);
-
-//	printf( "* is_mono: %d\n", is_mono);
-
-	channel_width[0] = luaL_optinteger(L, 3, 192);	// Default: 192
-	channel_flipped[0] = luaL_optinteger(L, 4, 0);	// Default: false
-	bar_size[0] = luaL_optinteger(L, 5, 6);		// Default: 6
-	clip_subbands[0] = luaL_optinteger(L, 6, 0);	// Default: false
+	// don't change the parameters under the analysis thread
+	vis_analysis_lock();
 
-//	printf( "* channel_width[0]: %d\n", channel_width[0]);
-//	printf( "* channel_flipped[0]: %d\n", channel_flipped[0]);
-//	printf( "* bar_size[0]: %d\n", bar_size[0]);
-//	printf( "* clip_subbands[0]: %d\n", clip_subbands[0]);
+	is_mono = mono;
 
-	if( !is_mono) {
-		channel_width[1] = luaL_optinteger(L, 7, 192);
-		channel_flipped[1] = luaL_optinteger(L, 8, 0);
-		bar_size[1] = luaL_optinteger(L, 9, 2);
-		clip_subbands[1] = luaL_optinteger(L, 10, 0);
-
-//		printf( "* channel_width[1]: %d\n", channel_width[1]);
-//		printf( "* channel_flipped[1]: %d\n", channel_flipped[1]);
-//		printf( "* bar_size[1]: %d\n", bar_size[1]);
-//		printf( "* clip_subbands[1]: %d\n", clip_subbands[1]);
+	for( ch = 0; ch < (( is_mono) ? 1 : 2); ch++) {
+		channel_width[ch] = width[ch];
+		channel_flipped[ch] = flipped[ch];
+		bar_size[ch] = ( size[ch] > 0) ? size[ch] : 1;
+		clip_subbands[ch] = clip[ch];
 	}
 
 	// Approximate the number of subbands we'll display based
@@ -253,12 +245,12 @@ int visualizer_spectrum_init( lua_State *L) {
 		num_windows = 1;
 	}
 
-	if( cfg) {
-		free( cfg);
-		cfg = NULL;
+	if( fft_ready) {
+		spectrum_fft_free( &fft);
+		fft_ready = 0;
 	}
 
-	if( !cfg) {
+	if( !fft_ready) {
 		double const1;
 		double const2;
 		int w;
@@ -269,7 +261,7 @@ int visualizer_spectrum_init( lua_State *L) {
 
 		int s;
 
-		cfg = kiss_fft_alloc( sample_window, 0, NULL, NULL);
+		fft_ready = spectrum_fft_init( &fft, SPECTRUM_FFT_MODE, sample_window);
 
 // Still needed?
 //		mem_addr_t lvptr = (mem_addr_t) last_values->aligned;
@@ -284,7 +276,7 @@ int visualizer_spectrum_init( lua_State *L) {
 		const2 = 0.46;
 		for( w = 0; w < sample_window; w++) {
 			const double twopi = 6.283185307179586476925286766;
-			filter_window[w] = const1 - ( const2 * cos( twopi * (double) w / (double) sample_window));
+			filter_window[w] = (float) (const1 - ( const2 * cos( twopi * (double) w / (double) sample_window)));
 		}
 
 		// Compute the preemphasis
@@ -309,14 +301,14 @@ int visualizer_spectrum_init( lua_State *L) {
 
 			}
 			if( scale_db != 0) {
-				preemphasis[s] = pow( 10, ( scale_db / 10.0));
+				preemphasis[s] = pow( 10, ( scale_db / 10.0)) / 65536;
 			} else {
-				preemphasis[s] = 1;
+				preemphasis[s] = 1.0f / 65536;
 			}
 			freq_sum += (vis_get_rate() / 1000) / ((float)(num_subbands * X_SCALE_LOG) / decade_len[s]);
 		}
 		decade_len[s] = (num_subbands * X_SCALE_LOG) - decade_idx[s] + 1;
-		preemphasis[s] = pow( 10, ( scale_db / 10.0));
+		preemphasis[s] = pow( 10, ( scale_db / 10.0)) / 65536;
 
 //		for( s = 0; s < num_subbands; s++) {
 //			printf("subband: %d, decade_idx: %d, decade_len: %d, preemphasis: %f\n", s, decade_idx[s], decade_len[s], preemphasis[s]);
@@ -324,18 +316,52 @@ int visualizer_spectrum_init( lua_State *L) {
 
 	}
 
+	bars[0] = num_bars[0];
+	bars[1] = num_bars[1];
+
+	vis_analysis_unlock();
+}
+
+
+// Parameters on the lua stack for the spectrum analyzer:
+//   2 - Channels: stereo == 0, mono == 1
+// Left channel parameters:
+//   3 - Width in pixels
+//   4 - orientation: left to right == 0, right to left == 1
+//   5 - Bar size in pixels
+//   6 - Clipping: show all subbands == 0, clip higher subbands == 1
+// Right channel parameters (not required for mono):
+//   7-10 - same as left channel parameters
+
+int visualizer_spectrum_init( lua_State *L) {
+	int width[2], flipped[2], size[2], clip[2], bars[2];
+
+	width[0] = luaL_optinteger(L, 3, 192);		// Default: 192
+	flipped[0] = luaL_optinteger(L, 4, 0);		// Default: false
+	size[0] = luaL_optinteger(L, 5, 6);		// Default: 6
+	clip[0] = luaL_optinteger(L, 6, 0);		// Default: false
+
+	width[1] = luaL_optinteger(L, 7, 192);
+	flipped[1] = luaL_optinteger(L, 8, 0);
+	size[1] = luaL_optinteger(L, 9, 2);
+	clip[1] = luaL_optinteger(L, 10, 0);
+
+	spectrum_configure( luaL_optinteger(L, 2, 0), width, flipped, size, clip, bars);
+
 	// Return calculated number of bars for each channel
 	lua_newtable( L);
-	lua_pushinteger( L, num_bars[0]);
+	lua_pushinteger( L, bars[0]);
 	lua_rawseti( L, -2, 1);
-	lua_pushinteger( L, num_bars[1]);
+	lua_pushinteger( L, bars[1]);
 	lua_rawseti( L, -2, 2);
 
 	return 1;
 }
 
 
-int visualizer_spectrum( lua_State *L) {
+// Run the spectrum analysis into snap, called with the analysis lock
+// held. The bins are in display order, flipped channels are reversed.
+void spectrum_analyse( struct vis_snapshot *snap) {
 	int sample_bin_ch0[MAX_SUBBANDS];
 	int sample_bin_ch1[MAX_SUBBANDS];
 
@@ -343,22 +369,13 @@ int visualizer_spectrum( lua_State *L) {
 	int w;
 	int ch;
 
-	vis_check();
-
-	// Shortcut if audio isn't running
-	if( !vis_get_playing()) {
-		lua_newtable( L);
-		for( i = 0; i < num_bars[0]; i++) {
-			lua_pushinteger( L, 0);
-			lua_rawseti( L, -2, i + 1);
-		}
+	snap->num_bars[0] = num_bars[0];
+	snap->num_bars[1] = num_bars[1];
 
-		lua_newtable( L);
-		for( i = 0; i < num_bars[1]; i++) {
-			lua_pushinteger( L, 0);
-			lua_rawseti( L, -2, i + 1);
-		}
-		return 2;
+	// Shortcut if audio isn't running, or we have not been initialised
+	if( !snap->playing || !fft_ready) {
+		memset( snap->bins, 0, sizeof( snap->bins));
+		return;
 	}
 
 	// Init avg_power
@@ -367,102 +384,41 @@ int visualizer_spectrum( lua_State *L) {
 	}
 
 	for( w = 0; w < num_windows; w++) {
-		kiss_fft_cpx fin_buf[MAX_SAMPLE_WINDOW];
-		kiss_fft_cpx fout_buf[MAX_SAMPLE_WINDOW];
-
-		int avg_ptr;
-		int s;
-
-		int16_t *ptr;
-		size_t samples_until_wrap;
-
-		int sample;
-
-		int offs;
 #if 0
 // Test case
 		{
 			double freq = ( M_PI * 16) / 256;
-			float ampl = ( (int) pow( 2, 16)) / 2;
+			float ampl = 16384;
 			int i;
 
 			for( i = 0; i < sample_window; i++) {
-				fin_buf[i].r = ( ampl * (float) sin( i * freq)) + ( ampl * (float) cos( i * freq));
-				fin_buf[i].i = ( ampl * (float) sin( i * freq)) + ( ampl * (float) cos( i * freq));
+				sample_buf[2 * i] = sample_buf[2 * i + 1] = ( ampl * (float) sin( i * freq)) + ( ampl * (float) cos( i * freq));
 			}
 		}
 #else
-		vis_lock();
-
-		offs = vis_get_buffer_idx() - (sample_window * 2) - (sample_window * 2 * w);
-		while (offs < 0) offs += vis_get_buffer_len();
-
-		ptr = vis_get_buffer() + offs;
-		samples_until_wrap = vis_get_buffer_len() - offs;
-
-		for( i = 0; i < sample_window; i++) {
-			sample = (*ptr++) >> 7;
-			fin_buf[i].r = (float) (filter_window[i] * sample);
-
-			sample = (*ptr++) >> 7;
-			fin_buf[i].i = (float) (filter_window[i] * sample);
-
-			samples_until_wrap -=2;
-			if( samples_until_wrap <= 0) {
-				ptr = vis_get_buffer();
-				samples_until_wrap = vis_get_buffer_len();
-			}
+		if( !vis_read( sample_buf, (sample_window * 2) + (sample_window * 2 * w), sample_window * 2)) {
+			memset( snap->bins, 0, sizeof( snap->bins));
+			return;
 		}
-
-		vis_unlock();
 #endif
 
-		kiss_fft( cfg, fin_buf, fout_buf);
-
-		// Extract the two separate frequency domain signals
-		// and keep track of the power per bin.
-		avg_ptr = 0;
-		for( s = 0; s < num_subbands; s++) {
-			kiss_fft_cpx ck, cnk;
-
-			float r = 0, i = 0;
-			int x;
-
-			for( x = decade_idx[s]; x < decade_idx[s] + decade_len[s]; x ++) {
-				ck = fout_buf[x];
-				cnk = fout_buf[sample_window - x];
-
-				r = ( ck.r + cnk.r) / 2;
-				i = ( ck.i - cnk.i) / 2;
-
-				avg_power[avg_ptr] += ( r * r + i * i) / num_windows;
-
-				r = ( cnk.i + ck.i) / 2;
-				i = ( cnk.r - ck.r) / 2;
-
-				avg_power[avg_ptr+1] += ( r * r + i * i) / num_windows;
-			}
-			avg_power[avg_ptr] /= decade_len[s];
-			avg_power[avg_ptr+1] /= decade_len[s];
-
-			avg_ptr += 2;
-		}
+		// Window, FFT, and keep track of the power per bin for
+		// each channel.
+		spectrum_fft_power( &fft, sample_buf, filter_window, decade_idx, decade_len,
+				    num_subbands, 1.0f / num_windows, avg_power);
 	}
 
-
 	{
 		int pre_ptr = 0;
 		int avg_ptr = 0;
 		int p;
 
 		for( p = 0; p < num_subbands; p++) {
-			long product = (long) ( avg_power[avg_ptr] * preemphasis[pre_ptr]);
-			product >>= 16;
-			avg_power[avg_ptr++] = (int) product;
+			avg_power[avg_ptr] = (int) ( avg_power[avg_ptr] * preemphasis[pre_ptr]);
+			avg_ptr++;
 
-			product = (long) ( avg_power[avg_ptr] * preemphasis[pre_ptr]);
-			product >>= 16;
-			avg_power[avg_ptr++] = (int) product;
+			avg_power[avg_ptr] = (int) ( avg_power[avg_ptr] * preemphasis[pre_ptr]);
+			avg_ptr++;
 
 			pre_ptr++;
 		}
@@ -530,24 +486,43 @@ int visualizer_spectrum( lua_State *L) {
 	}
 
 
-	lua_newtable( L);
 	for( i = 0; i < num_bars[0]; i++) {
 		if( channel_flipped[0] == 0) {
-			lua_pushinteger( L, sample_bin_ch0[i]);
+			snap->bins[0][i] = sample_bin_ch0[i];
 		} else {
-			lua_pushinteger( L, sample_bin_ch0[num_bars[0] - 1 - i]);
+			snap->bins[0][i] = sample_bin_ch0[num_bars[0] - 1 - i];
 		}
-		lua_rawseti( L, -2, i + 1);
 	}
 
-	lua_newtable( L);
 	for( i = 0; i < num_bars[1]; i++) {
 		if( channel_flipped[1] == 0) {
-			lua_pushinteger( L, sample_bin_ch1[i]);
+			snap->bins[1][i] = sample_bin_ch1[i];
 		} else {
-			lua_pushinteger( L, sample_bin_ch1[num_bars[1] - 1 - i]);
+			snap->bins[1][i] = sample_bin_ch1[num_bars[1] - 1 - i];
+		}
+	}
+}
+
+
+int visualizer_spectrum( lua_State *L) {
+	const struct vis_snapshot *snap;
+	int ch, i;
+
+	// Latest published analysis, never waits for the audio writer
+	snap = vis_analysis_snapshot( 0);
+
+	// The bar counts may have changed since the snapshot was taken,
+	// always return the number of bars from the last spectrum_init
+	for( ch = 0; ch < 2; ch++) {
+		lua_createtable( L, num_bars[ch], 0);
+		for( i = 0; i < num_bars[ch]; i++) {
+			if( snap->playing && i < snap->num_bars[ch]) {
+				lua_pushinteger( L, snap->bins[ch][i]);
+			} else {
+				lua_pushinteger( L, 0);
+			}
+			lua_rawseti( L, -2, i + 1);
 		}
-		lua_rawseti( L, -2, i + 1);
 	}
 
 	return 2;
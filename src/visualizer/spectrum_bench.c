@@ -0,0 +1,114 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+/*
+ * Benchmark the spectrum FFT kernels for each sample window size
+ * visualizer_spectrum_init can choose, and check they agree.
+ *
+ *   make bench && ./spectrum_bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "spectrum_fft.h"
+
+#define X_SCALE_LOG 20
+#define MIN_SUBBANDS 16
+#define MAX_SUBBANDS 512
+
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+// decade scale, as visualizer_spectrum_init
+static void decade_scale(int num_subbands, int *decade_idx, int *decade_len) {
+	double e = log(num_subbands * X_SCALE_LOG) / log(num_subbands);
+	int s;
+
+	decade_idx[0] = 1;
+	for (s = 0; s < num_subbands - 1; s++) {
+		decade_idx[s+1] = pow(s+1, e) + 1;
+		decade_len[s] = decade_idx[s+1] - decade_idx[s];
+	}
+	decade_len[s] = (num_subbands * X_SCALE_LOG) - decade_idx[s] + 1;
+}
+
+
+static double bench(int mode, int sample_window, int num_subbands, const int16_t *samples, const float *window,
+		    const int *decade_idx, const int *decade_len, float *power, int iterations) {
+	struct spectrum_fft fft;
+	double t0;
+	int i;
+
+	if (!spectrum_fft_init(&fft, mode, sample_window)) {
+		fprintf(stderr, "fft init failed\n");
+		exit(1);
+	}
+
+	t0 = now();
+	for (i = 0; i < iterations; i++) {
+		memset(power, 0, sizeof(float) * 2 * num_subbands);
+		spectrum_fft_power(&fft, samples, window, decade_idx, decade_len, num_subbands, 1.0f, power);
+	}
+	t0 = now() - t0;
+
+	spectrum_fft_free(&fft);
+
+	return t0 * 1e6 / iterations;
+}
+
+
+int main(int argc, char **argv) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 200;
+	int num_subbands;
+
+	printf("%8s %8s %12s %12s %8s %10s\n", "subbands", "window", "complex us", "real us", "speedup", "max diff");
+
+	for (num_subbands = MIN_SUBBANDS; num_subbands <= MAX_SUBBANDS; num_subbands <<= 1) {
+		int sample_window = num_subbands * 2 * X_SCALE_LOG;
+		int16_t *samples = malloc(sizeof(int16_t) * 2 * sample_window);
+		float *window = malloc(sizeof(float) * sample_window);
+		float cpower[2 * MAX_SUBBANDS], rpower[2 * MAX_SUBBANDS];
+		int decade_idx[MAX_SUBBANDS], decade_len[MAX_SUBBANDS];
+		double tc, tr, diff = 0;
+		int i;
+
+		srand(num_subbands);
+		for (i = 0; i < 2 * sample_window; i++) {
+			samples[i] = (rand() & 0xffff) - 0x8000;
+		}
+		for (i = 0; i < sample_window; i++) {
+			window[i] = 0.54 - 0.46 * cos(6.283185307179586 * i / sample_window);
+		}
+
+		decade_scale(num_subbands, decade_idx, decade_len);
+
+		tc = bench(SPECTRUM_FFT_COMPLEX, sample_window, num_subbands, samples, window, decade_idx, decade_len, cpower, iterations);
+		tr = bench(SPECTRUM_FFT_REAL, sample_window, num_subbands, samples, window, decade_idx, decade_len, rpower, iterations);
+
+		for (i = 0; i < 2 * num_subbands; i++) {
+			double d = fabs(cpower[i] - rpower[i]) / (fabs(cpower[i]) + 1);
+			if (d > diff) {
+				diff = d;
+			}
+		}
+
+		printf("%8d %8d %12.1f %12.1f %8.2f %10.2g\n", num_subbands, sample_window, tc, tr, tc / tr, diff);
+
+		free(samples);
+		free(window);
+	}
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#include "spectrum_fft.h"
+
+// Single precision throughout, the loops are kept simple with no
+// aliasing between input and output so the compiler can vectorise
+// them (SSE2 / NEON with -O2 -ftree-vectorize or -O3).
+
+
+int spectrum_fft_init(struct spectrum_fft *fft, int mode, int sample_window) {
+	memset(fft, 0, sizeof(struct spectrum_fft));
+
+	fft->mode = mode;
+	fft->sample_window = sample_window;
+
+	if (mode == SPECTRUM_FFT_REAL) {
+		fft->rcfg = kiss_fftr_alloc(sample_window, 0, NULL, NULL);
+		fft->rin[0] = malloc(sizeof(kiss_fft_scalar) * sample_window);
+		fft->rin[1] = malloc(sizeof(kiss_fft_scalar) * sample_window);
+		fft->rout[0] = malloc(sizeof(kiss_fft_cpx) * (sample_window / 2 + 1));
+		fft->rout[1] = malloc(sizeof(kiss_fft_cpx) * (sample_window / 2 + 1));
+
+		if (!fft->rcfg || !fft->rin[0] || !fft->rin[1] || !fft->rout[0] || !fft->rout[1]) {
+			spectrum_fft_free(fft);
+			return 0;
+		}
+	}
+	else {
+		fft->ccfg = kiss_fft_alloc(sample_window, 0, NULL, NULL);
+		fft->cin = malloc(sizeof(kiss_fft_cpx) * sample_window);
+		fft->cout = malloc(sizeof(kiss_fft_cpx) * sample_window);
+
+		if (!fft->ccfg || !fft->cin || !fft->cout) {
+			spectrum_fft_free(fft);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+void spectrum_fft_free(struct spectrum_fft *fft) {
+	free(fft->ccfg);
+	free(fft->cin);
+	free(fft->cout);
+
+	free(fft->rcfg);
+	free(fft->rin[0]);
+	free(fft->rin[1]);
+	free(fft->rout[0]);
+	free(fft->rout[1]);
+
+	memset(fft, 0, sizeof(struct spectrum_fft));
+}
+
+
+static void spectrum_fft_complex(struct spectrum_fft *fft, const int16_t *samples, const float *window,
+				 const int *decade_idx, const int *decade_len, int num_subbands,
+				 float scale, float *power) {
+	kiss_fft_cpx *fin = fft->cin;
+	kiss_fft_cpx *fout = fft->cout;
+	int n = fft->sample_window;
+	int i, s, x;
+
+	for (i = 0; i < n; i++) {
+		fin[i].r = window[i] * (float)(samples[2 * i] >> 7);
+		fin[i].i = window[i] * (float)(samples[2 * i + 1] >> 7);
+	}
+
+	kiss_fft(fft->ccfg, fin, fout);
+
+	// Extract the two separate frequency domain signals
+	for (s = 0; s < num_subbands; s++) {
+		float p0 = 0, p1 = 0;
+
+		for (x = decade_idx[s]; x < decade_idx[s] + decade_len[s]; x++) {
+			kiss_fft_cpx ck = fout[x];
+			kiss_fft_cpx cnk = fout[n - x];
+			float r, im;
+
+			r = (ck.r + cnk.r) * 0.5f;
+			im = (ck.i - cnk.i) * 0.5f;
+			p0 += r * r + im * im;
+
+			r = (cnk.i + ck.i) * 0.5f;
+			im = (cnk.r - ck.r) * 0.5f;
+			p1 += r * r + im * im;
+		}
+
+		power[2 * s] += p0 * scale / decade_len[s];
+		power[2 * s + 1] += p1 * scale / decade_len[s];
+	}
+}
+
+
+static void spectrum_fft_real(struct spectrum_fft *fft, const int16_t *samples, const float *window,
+			      const int *decade_idx, const int *decade_len, int num_subbands,
+			      float scale, float *power) {
+	kiss_fft_scalar *restrict in0 = fft->rin[0];
+	kiss_fft_scalar *restrict in1 = fft->rin[1];
+	int n = fft->sample_window;
+	int i, s, x, ch;
+
+	for (i = 0; i < n; i++) {
+		in0[i] = window[i] * (float)(samples[2 * i] >> 7);
+		in1[i] = window[i] * (float)(samples[2 * i + 1] >> 7);
+	}
+
+	kiss_fftr(fft->rcfg, in0, fft->rout[0]);
+	kiss_fftr(fft->rcfg, in1, fft->rout[1]);
+
+	for (ch = 0; ch < 2; ch++) {
+		const kiss_fft_cpx *restrict out = fft->rout[ch];
+
+		for (s = 0; s < num_subbands; s++) {
+			int end = decade_idx[s] + decade_len[s];
+			float p = 0;
+
+			for (x = decade_idx[s]; x < end; x++) {
+				p += out[x].r * out[x].r + out[x].i * out[x].i;
+			}
+
+			power[2 * s + ch] += p * scale / decade_len[s];
+		}
+	}
+}
+
+
+void spectrum_fft_power(struct spectrum_fft *fft, const int16_t *samples, const float *window,
+			const int *decade_idx, const int *decade_len, int num_subbands,
+			float scale, float *power) {
+	if (fft->mode == SPECTRUM_FFT_REAL) {
+		spectrum_fft_real(fft, samples, window, decade_idx, decade_len, num_subbands, scale, power);
+	}
+	else {
+		spectrum_fft_complex(fft, samples, window, decade_idx, decade_len, num_subbands, scale, power);
+	}
+}
@@ -0,0 +1,44 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#ifndef SPECTRUM_FFT_H
+#define SPECTRUM_FFT_H
+
+#include <stdint.h>
+
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+
+// FFT kernels for the spectrum analyser, the complex kernel packs
+// left and right into one complex FFT, the real kernel runs a real
+// input FFT per channel.
+#define SPECTRUM_FFT_COMPLEX 0
+#define SPECTRUM_FFT_REAL 1
+
+struct spectrum_fft {
+	int mode;
+	int sample_window;
+
+	kiss_fft_cfg ccfg;
+	kiss_fft_cpx *cin;
+	kiss_fft_cpx *cout;
+
+	kiss_fftr_cfg rcfg;
+	kiss_fft_scalar *rin[2];
+	kiss_fft_cpx *rout[2];
+};
+
+extern int spectrum_fft_init(struct spectrum_fft *fft, int mode, int sample_window);
+extern void spectrum_fft_free(struct spectrum_fft *fft);
+
+// Window the interleaved stereo samples, run the FFT and add the
+// average power over each subband, times scale, to power. power is
+// interleaved left/right per subband.
+extern void spectrum_fft_power(struct spectrum_fft *fft, const int16_t *samples, const float *window,
+			       const int *decade_idx, const int *decade_len, int num_subbands,
+			       float scale, float *power);
+
+#endif // SPECTRUM_FFT_H
@@ -0,0 +1,61 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+#ifndef VIS_SHM_H
+#define VIS_SHM_H
+
+#include <stdint.h>
+
+/*
+ * Version 2 of the shared memory layout used by the audio player to
+ * publish the visualizer samples. Standalone so it can be shared with
+ * the writer.
+ *
+ * There is no lock. The writer copies samples into the ring, then
+ * updates the header inside a sequence count: seq is made odd, the
+ * header fields written, and seq made even again. Readers retry while
+ * seq is odd or has changed.
+ *
+ * buf_index is the total number of samples written, wrapping at 2^32.
+ * The ring is a power of two so the write position is buf_index masked
+ * by buf_size - 1. The writer never writes more than VIS_SHM_MAX_WRITE
+ * samples between index updates, a reader's copy is good if the index
+ * has not moved more than buf_size - VIS_SHM_MAX_WRITE past its start.
+ *
+ * heartbeat is incremented on every update, also when the player is
+ * stopped. A reader treats the writer as gone if it has not changed for
+ * a few seconds.
+ */
+
+#define VIS_SHM_NAME		"/squeezelite-v2-%s"	/* mac address */
+
+#define VIS_SHM_MAGIC		0x32534956		/* "VIS2" */
+#define VIS_SHM_VERSION		2
+
+/* ring size in samples (interleaved stereo), must be a power of two */
+#define VIS_SHM_BUF_SIZE	(1 << 16)
+#define VIS_SHM_MAX_WRITE	(VIS_SHM_BUF_SIZE / 8)
+
+struct vis_shm {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;			/* size of the mapping in bytes */
+	uint32_t buf_size;		/* ring size in samples */
+
+	volatile uint32_t seq;
+	volatile uint32_t running;
+	volatile uint32_t rate;
+	volatile uint32_t heartbeat;
+	volatile uint32_t buf_index;
+
+	uint32_t reserved[7];
+
+	int16_t buffer[];
+};
+
+#define VIS_SHM_SIZE(buf_size)	(sizeof(struct vis_shm) + (buf_size) * sizeof(int16_t))
+
+#endif // VIS_SHM_H
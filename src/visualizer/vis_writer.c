@@ -0,0 +1,185 @@
+/*
+** Copyright 2010 Logitech. All Rights Reserved.
+**
+** This file is licensed under BSD. Please see the LICENSE file for details.
+*/
+
+/*
+ * Simulate the audio player's side of the version 2 visualizer shared
+ * memory, so the meters can be tested without a player. Writes a tone
+ * sweeping across the spectrum with a pulsing level, alternating
+ * between playing and paused if asked to.
+ *
+ *   make writer && UTMAC=00:11:22:33:44:55 ./vis_writer
+ *
+ * Run jivelite with the same UTMAC, or pass the player's mac with -m.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "vis_shm.h"
+
+// interval between writes in ms
+#define WRITE_INTERVAL 10
+
+static volatile sig_atomic_t quit = 0;
+
+
+static void usage(const char *name) {
+	fprintf(stderr,
+		"usage: %s [-m mac] [-r rate] [-p seconds] [-s seconds] [-k]\n"
+		"  -m mac      mac address, defaults to $UTMAC\n"
+		"  -r rate     sample rate, default 44100\n"
+		"  -p seconds  pause for this long every other period, default never\n"
+		"  -s seconds  stop after this long, default run until interrupted\n"
+		"  -k          stop updating the heartbeat after -s, to test a stalled writer\n",
+		name);
+	exit(1);
+}
+
+
+static void on_signal(int sig) {
+	quit = 1;
+}
+
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static void update(struct vis_shm *shm, uint32_t running, uint32_t rate, uint32_t idx) {
+	shm->seq++;
+	__sync_synchronize();
+
+	shm->running = running;
+	shm->rate = rate;
+	shm->heartbeat++;
+	shm->buf_index = idx;
+
+	__sync_synchronize();
+	shm->seq++;
+}
+
+
+int main(int argc, char **argv) {
+	const char *mac = getenv("UTMAC");
+	int rate = 44100;
+	double pause = 0, stop = 0;
+	int stall = 0;
+	char shm_path[40];
+	struct vis_shm *shm;
+	size_t size;
+	int fd, opt;
+	uint32_t idx = 0;
+	double start, phase = 0;
+
+	while ((opt = getopt(argc, argv, "m:r:p:s:k")) != -1) {
+		switch (opt) {
+		case 'm': mac = optarg; break;
+		case 'r': rate = atoi(optarg); break;
+		case 'p': pause = atof(optarg); break;
+		case 's': stop = atof(optarg); break;
+		case 'k': stall = 1; break;
+		default: usage(argv[0]);
+		}
+	}
+
+	if (!mac || rate <= 0 || rate / (1000 / WRITE_INTERVAL) * 2 > VIS_SHM_MAX_WRITE) {
+		usage(argv[0]);
+	}
+
+	snprintf(shm_path, sizeof(shm_path), VIS_SHM_NAME, mac);
+	size = VIS_SHM_SIZE(VIS_SHM_BUF_SIZE);
+
+	fd = shm_open(shm_path, O_RDWR | O_CREAT, 0666);
+	if (fd < 0 || ftruncate(fd, size) < 0) {
+		perror(shm_path);
+		return 1;
+	}
+
+	shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	memset(shm, 0, size);
+	shm->version = VIS_SHM_VERSION;
+	shm->size = size;
+	shm->buf_size = VIS_SHM_BUF_SIZE;
+	__sync_synchronize();
+	shm->magic = VIS_SHM_MAGIC;
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	printf("writing %s, %d Hz\n", shm_path, rate);
+
+	start = now();
+
+	while (!quit) {
+		double t = now() - start;
+		int frames = rate * WRITE_INTERVAL / 1000;
+		uint32_t running = 1;
+		double freq, level;
+		int i;
+
+		if (stop > 0 && t > stop) {
+			if (!stall) {
+				break;
+			}
+
+			// leave the segment running with no heartbeat
+			usleep(WRITE_INTERVAL * 1000);
+			continue;
+		}
+
+		if (pause > 0 && ((int)(t / pause) & 1)) {
+			running = 0;
+		}
+
+		if (running) {
+			// sweep 50Hz to 15kHz every 10s, level pulsing twice a second
+			freq = 50 * pow(300, fmod(t, 10) / 10);
+			level = 0.5 + 0.5 * sin(t * 2 * M_PI * 2);
+
+			for (i = 0; i < frames; i++) {
+				int16_t l, r;
+
+				phase += 2 * M_PI * freq / rate;
+				l = (int16_t)(32767 * level * sin(phase));
+				r = (int16_t)(32767 * (1 - level) * sin(phase));
+
+				shm->buffer[idx & (VIS_SHM_BUF_SIZE - 1)] = l;
+				idx++;
+				shm->buffer[idx & (VIS_SHM_BUF_SIZE - 1)] = r;
+				idx++;
+			}
+			phase = fmod(phase, 2 * M_PI);
+		}
+
+		update(shm, running, rate, idx);
+
+		usleep(WRITE_INTERVAL * 1000);
+	}
+
+	update(shm, 0, rate, idx);
+
+	munmap(shm, size);
+	shm_unlink(shm_path);
+
+	return 0;
+}
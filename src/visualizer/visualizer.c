@@ -1,13 +1,24 @@
 #include "../common.h"
 #include "../jive.h"
 
+#include "vis_shm.h"
+
 #include <pthread.h>
 
 #include <stdio.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #define VIS_BUF_SIZE 16384
 
+// Seconds without a heartbeat, or an update from a legacy writer,
+// before the mapping is reopened
+#define VIS_STALE 5
+
+// Reader retries while the writer is updating the header
+#define VIS_RETRIES 4
+
+// Legacy layout, the writer's lock is taken for every read
 static struct vis_t {
 	pthread_rwlock_t rwlock;
 	u32_t buf_size;
@@ -18,28 +29,88 @@ static struct vis_t {
 	s16_t buffer[VIS_BUF_SIZE];
 } * vis_mmap = NULL;
 
+// Version 2 layout, see vis_shm.h
+static struct vis_shm *vis_shm = NULL;
+static size_t vis_shm_size = 0;
+
 static bool running = false; // cached version of running so now playing status can be read without lock
+static u32_t rate = 0;
 static int vis_fd = -1;
 static char *mac_address = NULL;
 
-static void _reopen(void) {
-	char shm_path[40];
+static u32_t heartbeat = 0;
+static time_t heartbeat_time = 0;
 
+static void _close(void) {
 	if (vis_mmap) {
 		munmap(vis_mmap, sizeof(struct vis_t));
 		vis_mmap = NULL;
 	}
 
+	if (vis_shm) {
+		munmap(vis_shm, vis_shm_size);
+		vis_shm = NULL;
+	}
+
 	if (vis_fd != -1) {
 		close(vis_fd);
 		vis_fd = -1;
 	}
 
-	if (!mac_address) {
-		mac_address = platform_get_mac_address();
+	running = false;
+}
+
+static bool _open_v2(void) {
+	char shm_path[40];
+	struct stat st;
+	struct vis_shm *shm;
+
+	snprintf(shm_path, sizeof(shm_path), VIS_SHM_NAME, mac_address ? mac_address : "");
+
+	vis_fd = shm_open(shm_path, O_RDONLY, 0666);
+	if (vis_fd < 0) {
+		return false;
+	}
+
+	if (fstat(vis_fd, &st) < 0 || st.st_size < (off_t)sizeof(struct vis_shm)) {
+		close(vis_fd);
+		vis_fd = -1;
+		return false;
+	}
+
+	shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, vis_fd, 0);
+	if (shm == MAP_FAILED) {
+		close(vis_fd);
+		vis_fd = -1;
+		return false;
+	}
+
+	// the ring must be a power of two, and fit in the mapping
+	if (shm->magic != VIS_SHM_MAGIC || shm->version != VIS_SHM_VERSION ||
+	    shm->buf_size == 0 || (shm->buf_size & (shm->buf_size - 1)) ||
+	    shm->size > st.st_size || VIS_SHM_SIZE(shm->buf_size) > shm->size) {
+		munmap(shm, st.st_size);
+		close(vis_fd);
+		vis_fd = -1;
+		return false;
+	}
+
+	vis_shm = shm;
+	vis_shm_size = st.st_size;
+
+	// keep the heartbeat time if this is the same stalled writer
+	if (shm->heartbeat != heartbeat || heartbeat_time == 0) {
+		heartbeat = shm->heartbeat;
+		heartbeat_time = time(NULL);
 	}
 
-	sprintf(shm_path, "/squeezelite-%s", mac_address ? mac_address : "");
+	return true;
+}
+
+static void _open_v1(void) {
+	char shm_path[40];
+
+	snprintf(shm_path, sizeof(shm_path), "/squeezelite-%s", mac_address ? mac_address : "");
 
 	vis_fd = shm_open(shm_path, O_RDWR, 0666);
 	if (vis_fd > 0) {
@@ -52,33 +123,108 @@ static void _reopen(void) {
 	}
 }
 
+static void _reopen(void) {
+	_close();
+
+	if (!mac_address) {
+		mac_address = platform_get_mac_address();
+	}
+
+	// prefer the lock free layout, fall back to the legacy one
+	if (!_open_v2()) {
+		_open_v1();
+	}
+}
+
+// read the header fields inside the writer's sequence count
+static bool _read_header_v2(u32_t *idx) {
+	int retry;
+
+	for (retry = 0; retry < VIS_RETRIES; retry++) {
+		u32_t seq = vis_shm->seq;
+		bool r;
+		u32_t hz, hb, i;
+
+		if (seq & 1) {
+			continue;
+		}
+		__sync_synchronize();
+
+		r = vis_shm->running;
+		hz = vis_shm->rate;
+		hb = vis_shm->heartbeat;
+		i = vis_shm->buf_index;
+
+		__sync_synchronize();
+		if (seq == vis_shm->seq) {
+			running = r;
+			rate = hz;
+			if (hb != heartbeat) {
+				heartbeat = hb;
+				heartbeat_time = time(NULL);
+			}
+			if (idx) {
+				*idx = i;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool _check_v2(time_t now) {
+	_read_header_v2(NULL);
+
+	// the writer has gone, it may have restarted with a new segment
+	if (now - heartbeat_time > VIS_STALE) {
+		running = false;
+		return false;
+	}
+
+	return true;
+}
+
+static bool _check_v1(time_t now) {
+	bool ok;
+
+	pthread_rwlock_rdlock(&vis_mmap->rwlock);
+
+	running = vis_mmap->running;
+	rate = vis_mmap->rate;
+
+	ok = !(running && now - vis_mmap->updated > VIS_STALE);
+
+	pthread_rwlock_unlock(&vis_mmap->rwlock);
+
+	return ok;
+}
+
 // check status of mmap, attempt to open or reopen if it has not been updated recently
 // this allows squeezelite to be restarted and to map a different block of memory
 void vis_check(void) {
 	static time_t lastopen = 0;
 	time_t now = time(NULL);
+	bool ok;
 
-	if (!vis_mmap) {
-		if (now - lastopen > 5) {
+	if (!vis_mmap && !vis_shm) {
+		if (now - lastopen > VIS_STALE) {
 			_reopen();
 			lastopen = now;
 		}
-		if (!vis_mmap) return;
+		if (!vis_mmap && !vis_shm) return;
 	}
 
-	pthread_rwlock_rdlock(&vis_mmap->rwlock);
+	ok = vis_shm ? _check_v2(now) : _check_v1(now);
 
-	running = vis_mmap->running;
-
-	if (running && now - vis_mmap->updated > 5) {
-		pthread_rwlock_unlock(&vis_mmap->rwlock);
+	if (!ok && now - lastopen > VIS_STALE) {
 		_reopen();
 		lastopen = now;
-	} else {
-		pthread_rwlock_unlock(&vis_mmap->rwlock);
 	}
 }
 
+// the version 2 layout is lock free, these are only needed for the
+// legacy layout
 void vis_lock(void) {
 	if (!vis_mmap) return;
 	pthread_rwlock_rdlock(&vis_mmap->rwlock);
@@ -90,38 +236,119 @@ void vis_unlock(void) {
 }
 
 bool vis_get_playing(void) {
-	if (!vis_mmap) return false;
+	if (!vis_mmap && !vis_shm) return false;
 	return running;
 }
 
 u32_t vis_get_rate(void) {
+	if (vis_shm) return rate;
 	if (!vis_mmap) return 0;
 	return vis_mmap->rate;
 }
 
 s16_t *vis_get_buffer(void) {
+	if (vis_shm) return vis_shm->buffer;
 	if (!vis_mmap) return NULL;
 	return vis_mmap->buffer;
 }
 
 u32_t vis_get_buffer_len(void) {
+	if (vis_shm) return vis_shm->buf_size;
 	if (!vis_mmap) return 0;
 	return vis_mmap->buf_size;
 }
 
 u32_t vis_get_buffer_idx(void) {
+	if (vis_shm) return vis_shm->buf_index & (vis_shm->buf_size - 1);
 	if (!vis_mmap) return 0;
 	return vis_mmap->buf_index;
 }
 
+static void _copy(s16_t *dst, s16_t *buf, u32_t buf_len, u32_t offs, u32_t len) {
+	u32_t n;
+
+	while (len) {
+		n = buf_len - offs;
+		if (n > len) n = len;
+
+		memcpy(dst, buf + offs, n * sizeof(s16_t));
+		dst += n;
+		len -= n;
+		offs = 0;
+	}
+}
+
+// copy without a lock, retry if the writer has overrun the window
+static bool _read_v2(s16_t *dst, u32_t back, u32_t len) {
+	u32_t buf_len = vis_shm->buf_size;
+	u32_t mask = buf_len - 1;
+	int retry;
+
+	if (back > buf_len - VIS_SHM_MAX_WRITE || len > back) {
+		return false;
+	}
+
+	for (retry = 0; retry < VIS_RETRIES; retry++) {
+		u32_t idx, start;
+
+		if (!_read_header_v2(&idx)) {
+			continue;
+		}
+
+		start = idx - back;
+		_copy(dst, vis_shm->buffer, buf_len, start & mask, len);
+
+		__sync_synchronize();
+		if (vis_shm->buf_index - start <= buf_len - VIS_SHM_MAX_WRITE) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// copy len samples, starting back samples before the current write
+// position, holding the writer's lock only for the copy
+static bool _read_v1(s16_t *dst, u32_t back, u32_t len) {
+	u32_t buf_len, offs;
+
+	pthread_rwlock_rdlock(&vis_mmap->rwlock);
+
+	buf_len = vis_mmap->buf_size;
+	if (buf_len == 0 || buf_len > VIS_BUF_SIZE) {
+		pthread_rwlock_unlock(&vis_mmap->rwlock);
+		return false;
+	}
+
+	offs = (vis_mmap->buf_index + buf_len - (back % buf_len)) % buf_len;
+
+	_copy(dst, vis_mmap->buffer, buf_len, offs, len);
+
+	pthread_rwlock_unlock(&vis_mmap->rwlock);
+
+	return true;
+}
+
+// copy len samples, starting back samples before the current write
+// position
+bool vis_read(s16_t *dst, u32_t back, u32_t len) {
+	if (vis_shm) return _read_v2(dst, back, len);
+	if (vis_mmap) return _read_v1(dst, back, len);
+	return false;
+}
+
 extern int visualizer_spectrum_init(lua_State *L);
 extern int visualizer_spectrum(lua_State *L);
 extern int visualizer_vumeter(lua_State *L);
+extern int visualizer_analysis_rate(lua_State *L);
+extern void visualizer_meters_register(lua_State *L);
+extern void visualizer_scopes_register(lua_State *L);
 
 static const struct luaL_Reg visualizer_f[] = {
 	{ "vumeter", visualizer_vumeter },
 	{ "spectrum", visualizer_spectrum },
 	{ "spectrum_init", visualizer_spectrum_init },
+	{ "analysis_rate", visualizer_analysis_rate },
 	{ NULL, NULL }
 };
 
@@ -131,6 +358,8 @@ int luaopen_visualizer(lua_State *L) {
 	/* register lua functions */
 	lua_newtable(L);
 	luaL_register(L, NULL, visualizer_f);
+	visualizer_meters_register(L);
+	visualizer_scopes_register(L);
 	lua_setfield(L, -2, "vis");
 
 	return 0;
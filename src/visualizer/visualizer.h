@@ -8,3 +8,27 @@ extern u32_t vis_get_rate(void);
 extern s16_t *vis_get_buffer(void);
 extern u32_t vis_get_buffer_len(void);
 extern u32_t vis_get_buffer_idx(void);
+extern bool vis_read(s16_t *dst, u32_t back, u32_t len);
+
+// The maximum number of input samples sent to the FFT, and the maximum
+// number of subbands (and so bars) it produces, see spectrum.c
+#define X_SCALE_LOG 20
+#define MAX_SAMPLE_WINDOW 1024 * X_SCALE_LOG
+#define MAX_SUBBANDS MAX_SAMPLE_WINDOW / 2 / X_SCALE_LOG
+
+// Finished analysis, published by the analysis thread
+struct vis_snapshot {
+	bool playing;
+	int num_bars[2];
+	int bins[2][MAX_SUBBANDS];
+	s32_t rms[2];
+};
+
+extern void vis_analysis_lock(void);
+extern void vis_analysis_unlock(void);
+extern const struct vis_snapshot *vis_analysis_snapshot(int vumeter_window);
+extern u32_t vis_analysis_read_new(u32_t *pos, s16_t *dst, u32_t len);
+
+extern void spectrum_configure(int mono, const int width[2], const int flipped[2], const int size[2], const int clip[2], int bars[2]);
+extern void spectrum_analyse(struct vis_snapshot *snap);
+extern void vumeter_analyse(struct vis_snapshot *snap, int num_samples);
@@ -10,32 +10,29 @@
 #include "visualizer.h"
 
 #define VUMETER_DEFAULT_SAMPLE_WINDOW 1024 * 2
+#define VUMETER_MAX_SAMPLE_WINDOW 1024 * 8
 
-int visualizer_vumeter(lua_State *L) {
+// samples copied from the shared buffer, only used with the analysis
+// lock held
+static s16_t sample_buf[VUMETER_MAX_SAMPLE_WINDOW * 2];
+
+// Run the vu meter analysis into snap, called with the analysis lock held
+void vumeter_analyse(struct vis_snapshot *snap, int num_samples) {
 	long long sample_accumulator[2];
-	int16_t *ptr;
+	s16_t *ptr;
 	s16_t sample;
 	s32_t sample_sq;
-	size_t i, num_samples, samples_until_wrap;
+	int i;
 
-	int offs;
-
-	num_samples = luaL_optinteger(L, 2, VUMETER_DEFAULT_SAMPLE_WINDOW);
+	if (num_samples <= 0 || num_samples > VUMETER_MAX_SAMPLE_WINDOW) {
+		num_samples = VUMETER_DEFAULT_SAMPLE_WINDOW;
+	}
 
 	sample_accumulator[0] = 0;
 	sample_accumulator[1] = 0;
 
-	vis_check();
-
-	if (vis_get_playing()) {
-
-		vis_lock();
-
-		offs = vis_get_buffer_idx() - (num_samples * 2);
-		while (offs < 0) offs += vis_get_buffer_len();
-
-		ptr = vis_get_buffer() + offs;
-		samples_until_wrap = vis_get_buffer_len() - offs;
+	if (snap->playing && vis_read(sample_buf, num_samples * 2, num_samples * 2)) {
+		ptr = sample_buf;
 
 		for (i=0; i<num_samples; i++) {
 			sample = (*ptr++) >> 8;
@@ -45,24 +42,23 @@ int visualizer_vumeter(lua_State *L) {
 			sample = (*ptr++) >> 8;
 			sample_sq = sample * sample;
 			sample_accumulator[1] += sample_sq;
-
-			samples_until_wrap -= 2;
-			if (samples_until_wrap <= 0) {
-				ptr = vis_get_buffer();
-				samples_until_wrap = vis_get_buffer_len();
-			}
 		}
-
-		vis_unlock();
 	}
 
-	sample_accumulator[0] /= num_samples;
-	sample_accumulator[1] /= num_samples;
+	snap->rms[0] = sample_accumulator[0] / num_samples;
+	snap->rms[1] = sample_accumulator[1] / num_samples;
+}
+
+int visualizer_vumeter(lua_State *L) {
+	const struct vis_snapshot *snap;
+
+	// Latest published analysis, never waits for the audio writer
+	snap = vis_analysis_snapshot(luaL_optinteger(L, 2, VUMETER_DEFAULT_SAMPLE_WINDOW));
 
 	lua_newtable(L);
-	lua_pushinteger(L, sample_accumulator[0]);
+	lua_pushinteger(L, snap->playing ? snap->rms[0] : 0);
 	lua_rawseti(L, -2, 1);
-	lua_pushinteger(L, sample_accumulator[1]);
+	lua_pushinteger(L, snap->playing ? snap->rms[1] : 0);
 	lua_rawseti(L, -2, 2);
 
 	return 1;